@@ -0,0 +1,22 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+namespace city::bench {
+
+// Entity counts: 100 .. 100k
+inline void entity_counts(benchmark::internal::Benchmark* b) {
+    b->RangeMultiplier(10)->Range(100, 100'000);
+}
+
+// Square map side lengths in tiles: 64 .. 1024
+inline void map_sizes(benchmark::internal::Benchmark* b) {
+    b->RangeMultiplier(4)->Range(64, 1024);
+}
+
+// Message payload sizes: 10 .. 10k entity records
+inline void message_sizes(benchmark::internal::Benchmark* b) {
+    b->RangeMultiplier(10)->Range(10, 10'000);
+}
+
+} // namespace city::bench
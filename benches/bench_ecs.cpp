@@ -0,0 +1,122 @@
+#include "bench_common.hpp"
+#include "core/ecs/world.hpp"
+#include "core/game/components/transform.hpp"
+#include "core/game/components/player.hpp"
+
+using namespace city;
+
+static void BM_PoolGet(benchmark::State& state) {
+    const auto count = static_cast<u32>(state.range(0));
+    ComponentPool<Transform> pool;
+    for (u32 i = 0; i < count; ++i) {
+        pool.set(i, Transform{});
+    }
+
+    for (auto _ : state) {
+        f32 sum = 0.0f;
+        for (u32 i = 0; i < count; ++i) {
+            sum += pool.get(i)->position.x;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_PoolGet)->Apply(bench::entity_counts);
+
+static void BM_PoolSetRemove(benchmark::State& state) {
+    const auto count = static_cast<u32>(state.range(0));
+    ComponentPool<Transform> pool;
+    for (auto _ : state) {
+        for (u32 i = 0; i < count; ++i) {
+            pool.set(i, Transform{});
+        }
+        for (u32 i = 0; i < count; ++i) {
+            pool.remove(i);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count * 2);
+}
+BENCHMARK(BM_PoolSetRemove)->Apply(bench::entity_counts);
+
+// Every entity has a Transform; one in 20 is also a Player
+static void populate(World& world, u32 count) {
+    for (u32 i = 0; i < count; ++i) {
+        Entity e = world.create();
+        world.add_component<Transform>(e);
+        if (i % 20 == 0) world.add_component<Player>(e);
+    }
+}
+
+static void BM_WorldEachTransform(benchmark::State& state) {
+    World world;
+    populate(world, static_cast<u32>(state.range(0)));
+    for (auto _ : state) {
+        world.each<Transform>([](Entity, Transform& t) { t.position.x += t.velocity.x; });
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_WorldEachTransform)->Apply(bench::entity_counts);
+
+static void BM_WorldEachTransformPlayer(benchmark::State& state) {
+    World world;
+    populate(world, static_cast<u32>(state.range(0)));
+    for (auto _ : state) {
+        world.each<Transform, Player>([](Entity, Transform& t, Player& p) {
+            t.position.x += static_cast<f32>(p.input_direction.x);
+        });
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_WorldEachTransformPlayer)->Apply(bench::entity_counts);
+
+static void BM_ViewEachTransformPlayer(benchmark::State& state) {
+    World world;
+    populate(world, static_cast<u32>(state.range(0)));
+    auto& view = world.view<Transform, Player>();
+    for (auto _ : state) {
+        view.each([](Entity, Transform& t, Player& p) {
+            t.position.x += static_cast<f32>(p.input_direction.x);
+        });
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ViewEachTransformPlayer)->Apply(bench::entity_counts);
+
+static void BM_WorldCreateDestroy(benchmark::State& state) {
+    const auto count = static_cast<size_t>(state.range(0));
+    World world;
+    std::vector<Entity> entities(count);
+    for (auto _ : state) {
+        for (auto& e : entities) {
+            e = world.create();
+            world.add_component<Transform>(e);
+        }
+        for (Entity e : entities) {
+            world.destroy(e);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_WorldCreateDestroy)->Apply(bench::entity_counts);
+
+static void BM_WorldNetIdLookup(benchmark::State& state) {
+    World world;
+    std::vector<NetEntityId> ids;
+    for (i64 i = 0; i < state.range(0); ++i) {
+        Entity e = world.create();
+        ids.push_back(world.allocate_net_id());
+        world.assign_net_id(e, ids.back());
+    }
+    for (auto _ : state) {
+        u32 sum = 0;
+        for (NetEntityId id : ids) {
+            sum += world.get_by_net_id(id).index;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_WorldNetIdLookup)->Apply(bench::entity_counts);
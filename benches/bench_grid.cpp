@@ -0,0 +1,307 @@
+#include "bench_common.hpp"
+#include "core/game/systems/visibility.hpp"
+#include "core/grid/field_of_view.hpp"
+#include "core/grid/flow_field.hpp"
+#include "core/grid/hierarchical_pathfinder.hpp"
+#include "core/grid/pathfinder.hpp"
+#include "core/grid/tilemap.hpp"
+#include <bit>
+
+using namespace city;
+
+// Square map of floor tiles with a sparse wall pattern; arg = side length in tiles.
+// Bounded maps use the dense chunk grid, unbounded ones the chunk hash map.
+static TileMap make_map(i32 size, bool bounded) {
+    TileMap map;
+    if (bounded) map.set_bounds(size, size);
+    Tile floor;
+    floor.floor_id = 1;
+    Tile wall = floor;
+    wall.wall_id = 1;
+    wall.flags = TileFlags::Solid | TileFlags::Opaque;
+    for (i32 y = 0; y < size; ++y) {
+        for (i32 x = 0; x < size; ++x) {
+            map.set_tile({x, y}, (x % 13 == 0 && y % 7 != 0) ? wall : floor);
+        }
+    }
+    return map;
+}
+
+static void BM_TileMapGetTile(benchmark::State& state, bool bounded) {
+    const auto size = static_cast<i32>(state.range(0));
+    TileMap map = make_map(size, bounded);
+    for (auto _ : state) {
+        u32 passable = 0;
+        for (i32 y = 0; y < size; y += 3) {
+            for (i32 x = 0; x < size; x += 3) {
+                const Tile* tile = map.get_tile({x, y});
+                passable += tile && tile->is_passable();
+            }
+        }
+        benchmark::DoNotOptimize(passable);
+    }
+    state.SetItemsProcessed(state.iterations() * ((size + 2) / 3) * ((size + 2) / 3));
+}
+BENCHMARK_CAPTURE(BM_TileMapGetTile, unbounded, false)->Apply(bench::map_sizes);
+BENCHMARK_CAPTURE(BM_TileMapGetTile, bounded, true)->Apply(bench::map_sizes);
+
+// Rays from the map centre to every 8th tile on the border
+static void BM_TileMapLineOfSight(benchmark::State& state, bool bounded) {
+    const auto size = static_cast<i32>(state.range(0));
+    TileMap map = make_map(size, bounded);
+    TilePos center{size / 2, size / 2};
+    std::vector<TilePos> targets;
+    for (i32 i = 0; i < size; i += 8) {
+        targets.push_back({i, 0});
+        targets.push_back({i, size - 1});
+        targets.push_back({0, i});
+        targets.push_back({size - 1, i});
+    }
+
+    for (auto _ : state) {
+        u32 visible = 0;
+        for (TilePos target : targets) {
+            visible += map.has_line_of_sight(center, target);
+        }
+        benchmark::DoNotOptimize(visible);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<i64>(targets.size()));
+}
+BENCHMARK_CAPTURE(BM_TileMapLineOfSight, unbounded, false)->Apply(bench::map_sizes);
+BENCHMARK_CAPTURE(BM_TileMapLineOfSight, bounded, true)->Apply(bench::map_sizes);
+
+// Field of view of radius 15 from viewers spread over the map; arg = side length in tiles
+static void BM_FieldOfView(benchmark::State& state) {
+    const auto size = static_cast<i32>(state.range(0));
+    TileMap map = make_map(size, true);
+    FieldOfView fov;
+    u32 viewers = 0;
+    for (auto _ : state) {
+        size_t visible = 0;
+        for (i32 y = 8; y < size; y += 32) {
+            for (i32 x = 8; x < size; x += 32) {
+                fov.compute(map, {x, y}, 15);
+                visible += fov.visible_count();
+                ++viewers;
+            }
+        }
+        benchmark::DoNotOptimize(visible);
+    }
+    state.SetItemsProcessed(viewers);
+}
+BENCHMARK(BM_FieldOfView)->Apply(bench::map_sizes);
+
+// Same viewers through the cache with one tile edited per iteration, so only the views
+// over the edited chunk are recomputed
+static void BM_FieldOfViewCached(benchmark::State& state) {
+    const auto size = static_cast<i32>(state.range(0));
+    TileMap map = make_map(size, true);
+    FieldOfViewCache cache(map);
+    Tile tile = *map.get_tile({1, 1});
+    u32 viewers = 0;
+    i32 step = 0;
+    for (auto _ : state) {
+        tile.flags = (step++ & 1) ? TileFlags::Opaque : TileFlags::None;
+        map.set_tile({size / 2 + 1, size / 2 + 1}, tile);
+        size_t visible = 0;
+        for (i32 y = 8; y < size; y += 32) {
+            for (i32 x = 8; x < size; x += 32) {
+                visible += cache.get({x, y}, 15).visible_count();
+                ++viewers;
+            }
+        }
+        benchmark::DoNotOptimize(visible);
+    }
+    state.SetItemsProcessed(viewers);
+}
+BENCHMARK(BM_FieldOfViewCached)->Apply(bench::map_sizes);
+
+// Players spread over a 256 map plus four other entities per player; players come first
+// in the targets. A grid mover changes tile every ~9 ticks, so an eighth of the players
+// step each tick. Arg = player count.
+struct VisibilityScene {
+    std::vector<TilePos> targets;
+    size_t players;
+    u32 tick{0};
+
+    explicit VisibilityScene(size_t count) : targets(count * 5), players(count) {
+        for (size_t i = 0; i < targets.size(); ++i) {
+            targets[i] = {static_cast<i32>((i * 37) % 256), static_cast<i32>((i * 91 + 5) % 256)};
+        }
+    }
+
+    void step() {
+        for (size_t i = tick++ % 8; i < players; i += 8) targets[i].x ^= 1;
+    }
+};
+
+// Baseline: every player against every target in shout range with has_line_of_sight
+static void BM_VisibilityPairwise(benchmark::State& state) {
+    TileMap map = make_map(256, true);
+    VisibilityScene scene(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        scene.step();
+        u32 visible = 0;
+        for (size_t p = 0; p < scene.players; ++p) {
+            for (TilePos target : scene.targets) {
+                TilePos d = target - scene.targets[p];
+                if (d.x * d.x + d.y * d.y > SHOUT_RANGE * SHOUT_RANGE) continue;
+                visible += map.has_line_of_sight(scene.targets[p], target);
+            }
+        }
+        benchmark::DoNotOptimize(visible);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_VisibilityPairwise)->RangeMultiplier(4)->Range(16, 1024);
+
+static void BM_VisibilityPass(benchmark::State& state) {
+    TileMap map = make_map(256, true);
+    VisibilityScene scene(static_cast<size_t>(state.range(0)));
+    JobSystem jobs;
+    VisibilitySystem visibility(map, SHOUT_RANGE);
+    std::span<const TilePos> targets(scene.targets);
+    for (auto _ : state) {
+        scene.step();
+        visibility.update(targets.first(scene.players), targets, jobs);
+        benchmark::DoNotOptimize(visibility.sees(0, 0));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_VisibilityPass)->RangeMultiplier(4)->Range(16, 1024);
+
+// Region sync of the whole map: encode (as the server does) or decode (as the client does)
+static void BM_TileMapRegionSync(benchmark::State& state, bool decode) {
+    const auto size = static_cast<i32>(state.range(0));
+    TileMap map = make_map(size, true);
+    Serializer s;
+    map.serialize_region(s, Recti{0, 0, size, size});
+    std::vector<u8> encoded(s.data().begin(), s.data().end());
+    for (auto _ : state) {
+        if (decode) {
+            Deserializer d(encoded);
+            u32 count = d.read_u32();
+            Chunk chunk;
+            for (u32 i = 0; i < count; ++i) chunk.deserialize(d);
+            benchmark::DoNotOptimize(chunk);
+        } else {
+            s.clear();
+            map.serialize_region(s, Recti{0, 0, size, size});
+            benchmark::DoNotOptimize(s.data().data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<i64>(map.chunk_count()));
+    state.counters["bytes"] = static_cast<double>(encoded.size());
+}
+BENCHMARK_CAPTURE(BM_TileMapRegionSync, encode, false)->Apply(bench::map_sizes);
+BENCHMARK_CAPTURE(BM_TileMapRegionSync, decode, true)->Apply(bench::map_sizes);
+
+// Count blocked tiles over the whole (bounded) map: per-tile lookups vs 64-wide row masks
+static void BM_TileMapSolidScan(benchmark::State& state, bool use_masks) {
+    const auto size = static_cast<i32>(state.range(0));
+    TileMap map = make_map(size, true);
+    for (auto _ : state) {
+        i64 blocked = 0;
+        for (i32 y = 0; y < size; ++y) {
+            if (use_masks) {
+                for (i32 x = 0; x < size; x += 64) {
+                    blocked += std::popcount(map.row_mask(TilePlane::Solid, {x, y}, 64));
+                }
+            } else {
+                for (i32 x = 0; x < size; ++x) {
+                    blocked += !map.is_passable({x, y});
+                }
+            }
+        }
+        benchmark::DoNotOptimize(blocked);
+    }
+    state.SetItemsProcessed(state.iterations() * size * size);
+}
+BENCHMARK_CAPTURE(BM_TileMapSolidScan, per_tile, false)->Apply(bench::map_sizes);
+BENCHMARK_CAPTURE(BM_TileMapSolidScan, row_masks, true)->Apply(bench::map_sizes);
+
+// Corner to corner across the wall pattern
+static void BM_Pathfind(benchmark::State& state, PathAlgorithm algorithm) {
+    const auto size = static_cast<i32>(state.range(0));
+    TileMap map = make_map(size, true);
+    Pathfinder pathfinder(map);
+    PathOptions options;
+    options.algorithm = algorithm;
+    std::vector<TilePos> path;
+
+    for (auto _ : state) {
+        bool found = pathfinder.find_path({1, 1}, {size - 2, size - 2}, path, options);
+        benchmark::DoNotOptimize(found);
+    }
+    state.counters["expanded"] = pathfinder.last_expanded();
+}
+BENCHMARK_CAPTURE(BM_Pathfind, astar, PathAlgorithm::AStar)->Apply(bench::map_sizes);
+BENCHMARK_CAPTURE(BM_Pathfind, jump_point, PathAlgorithm::JumpPoint)->Apply(bench::map_sizes);
+
+static void BM_PathfindHierarchical(benchmark::State& state) {
+    const auto size = static_cast<i32>(state.range(0));
+    TileMap map = make_map(size, true);
+    HierarchicalPathfinder pathfinder(map);
+    pathfinder.update();
+    std::vector<TilePos> path;
+
+    for (auto _ : state) {
+        bool found = pathfinder.find_path({1, 1}, {size - 2, size - 2}, path);
+        benchmark::DoNotOptimize(found);
+    }
+    state.counters["expanded"] = pathfinder.last_expanded();
+    state.counters["nodes"] = static_cast<double>(pathfinder.node_count());
+}
+BENCHMARK(BM_PathfindHierarchical)->Apply(bench::map_sizes);
+
+// One tile toggled per iteration; only its chunk (and neighbours on a border change) rebuild
+static void BM_PathfindHierarchicalEdit(benchmark::State& state) {
+    const auto size = static_cast<i32>(state.range(0));
+    TileMap map = make_map(size, true);
+    HierarchicalPathfinder pathfinder(map);
+    pathfinder.update();
+    Tile floor;
+    floor.floor_id = 1;
+    Tile wall = floor;
+    wall.flags = TileFlags::Solid;
+
+    bool blocked = false;
+    for (auto _ : state) {
+        blocked = !blocked;
+        map.set_tile({size / 2 + 3, size / 2 + 5}, blocked ? wall : floor);
+        pathfinder.update();
+    }
+    state.counters["rebuilt"] = pathfinder.last_rebuilt_clusters();
+}
+BENCHMARK(BM_PathfindHierarchicalEdit)->Apply(bench::map_sizes);
+
+static void BM_FlowFieldBuild(benchmark::State& state) {
+    const auto size = static_cast<i32>(state.range(0));
+    TileMap map = make_map(size, true);
+    for (auto _ : state) {
+        FlowField field(map, {size / 2, size / 2});
+        benchmark::DoNotOptimize(field.cost_at({1, 1}));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+}
+BENCHMARK(BM_FlowFieldBuild)->Apply(bench::map_sizes);
+
+// One tile toggled per iteration; the integration field is repaired around it
+static void BM_FlowFieldEdit(benchmark::State& state) {
+    const auto size = static_cast<i32>(state.range(0));
+    TileMap map = make_map(size, true);
+    FlowField field(map, {size / 2, size / 2});
+    Tile floor;
+    floor.floor_id = 1;
+    Tile wall = floor;
+    wall.flags = TileFlags::Solid;
+
+    bool blocked = false;
+    for (auto _ : state) {
+        blocked = !blocked;
+        map.set_tile({size / 4 + 3, size / 4 + 5}, blocked ? wall : floor);
+        field.update();
+    }
+    state.counters["rebuilt"] = field.last_rebuilt_chunks();
+}
+BENCHMARK(BM_FlowFieldEdit)->Apply(bench::map_sizes);
@@ -0,0 +1,130 @@
+#include "bench_common.hpp"
+#include "core/game/systems/movement.hpp"
+#include "core/game/systems/spatial_index.hpp"
+
+using namespace city;
+
+namespace {
+
+struct Movers {
+    TileMap map;
+    std::vector<Transform> transforms;
+    std::vector<Player> players;
+
+    explicit Movers(size_t count) : transforms(count), players(count) {
+        Tile floor;
+        floor.floor_id = 1;
+        for (i32 y = 0; y < 128; ++y) {
+            for (i32 x = 0; x < 128; ++x) {
+                map.set_tile({x, y}, floor);
+            }
+        }
+        for (size_t i = 0; i < count; ++i) {
+            auto offset = static_cast<f32>(i % 100);
+            transforms[i].position = {10.5f + offset, 10.5f + offset};
+            players[i].movement_mode = i % 2 ? MovementMode::Free : MovementMode::GridLocked;
+            players[i].input_direction = {1, static_cast<i32>(i % 3) - 1};
+        }
+    }
+
+    // Walk back and forth so grid movers keep moving
+    void steer(size_t tick) {
+        i32 dir = (tick / 120) % 2 ? -1 : 1;
+        for (auto& player : players) {
+            player.input_direction.x = dir;
+        }
+    }
+};
+
+} // namespace
+
+static void BM_MoverScalar(benchmark::State& state) {
+    Movers movers(static_cast<size_t>(state.range(0)));
+    size_t tick = 0;
+    for (auto _ : state) {
+        movers.steer(tick++);
+        for (size_t i = 0; i < movers.transforms.size(); ++i) {
+            MoverSystem::update_movement(movers.transforms[i], movers.players[i], movers.map,
+                                         1.0f / 60.0f);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MoverScalar)->Apply(bench::entity_counts);
+
+// Movers heading for one shared goal: one field lookup per mover per tick
+static void BM_MoverFlowField(benchmark::State& state) {
+    Movers movers(static_cast<size_t>(state.range(0)));
+    FlowField field(movers.map, {120, 64});
+    for (auto _ : state) {
+        for (size_t i = 0; i < movers.transforms.size(); ++i) {
+            MoverSystem::steer_by_flow_field(movers.players[i], movers.transforms[i], field);
+            MoverSystem::update_movement(movers.transforms[i], movers.players[i], movers.map,
+                                         1.0f / 60.0f);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MoverFlowField)->Apply(bench::entity_counts);
+
+// Entities spread over a 512x512 area, all moving a little each tick (a few cross cells)
+static std::vector<Vec2f> scattered_positions(size_t count) {
+    std::vector<Vec2f> positions(count);
+    for (size_t i = 0; i < count; ++i) {
+        positions[i] = {static_cast<f32>((i * 7919) % 512) + 0.5f,
+                        static_cast<f32>((i * 104729) % 512) + 0.5f};
+    }
+    return positions;
+}
+
+static void BM_SpatialIndexMove(benchmark::State& state) {
+    std::vector<Vec2f> positions = scattered_positions(static_cast<size_t>(state.range(0)));
+    SpatialIndex index;
+    for (u32 i = 0; i < positions.size(); ++i) index.insert({i, 0}, positions[i]);
+    f32 step = 0.13f;
+    for (auto _ : state) {
+        for (u32 i = 0; i < positions.size(); ++i) {
+            positions[i].x += step;
+            index.move({i, 0}, positions[i]);
+        }
+        step = -step;
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SpatialIndexMove)->Apply(bench::entity_counts);
+
+// Local chat sized queries (radius 5) around every 100th entity
+static void BM_SpatialIndexQuery(benchmark::State& state) {
+    std::vector<Vec2f> positions = scattered_positions(static_cast<size_t>(state.range(0)));
+    SpatialIndex index;
+    for (u32 i = 0; i < positions.size(); ++i) index.insert({i, 0}, positions[i]);
+    std::vector<Entity> found;
+    for (auto _ : state) {
+        size_t total = 0;
+        for (size_t i = 0; i < positions.size(); i += 100) {
+            total += index.query_radius(positions[i], 5.0f, found);
+        }
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetItemsProcessed(state.iterations() * ((state.range(0) + 99) / 100));
+}
+BENCHMARK(BM_SpatialIndexQuery)->Apply(bench::entity_counts);
+
+// Baseline: the same queries as a scan over every position
+static void BM_SpatialScanQuery(benchmark::State& state) {
+    std::vector<Vec2f> positions = scattered_positions(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        size_t total = 0;
+        for (size_t i = 0; i < positions.size(); i += 100) {
+            for (Vec2f position : positions) {
+                Vec2f d = position - positions[i];
+                total += d.x * d.x + d.y * d.y <= 25.0f;
+            }
+        }
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetItemsProcessed(state.iterations() * ((state.range(0) + 99) / 100));
+}
+BENCHMARK(BM_SpatialScanQuery)->Apply(bench::entity_counts);
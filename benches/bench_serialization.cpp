@@ -0,0 +1,58 @@
+#include "bench_common.hpp"
+#include "core/net/serialization.hpp"
+
+using namespace city;
+
+// Message-sized payloads: arg = number of entity records (net_id + position + velocity)
+static void BM_SerializeEntityRecords(benchmark::State& state) {
+    const auto count = static_cast<u32>(state.range(0));
+    for (auto _ : state) {
+        Serializer s;
+        s.write_u32(count);
+        for (u32 i = 0; i < count; ++i) {
+            s.write_u32(i);
+            s.write_vec2f({static_cast<f32>(i), 1.5f});
+            s.write_vec2f({0.25f, -0.25f});
+        }
+        benchmark::DoNotOptimize(s.data().data());
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_SerializeEntityRecords)->Apply(bench::message_sizes);
+
+static void BM_DeserializeEntityRecords(benchmark::State& state) {
+    const auto count = static_cast<u32>(state.range(0));
+    Serializer s;
+    s.write_u32(count);
+    for (u32 i = 0; i < count; ++i) {
+        s.write_u32(i);
+        s.write_vec2f({static_cast<f32>(i), 1.5f});
+        s.write_vec2f({0.25f, -0.25f});
+    }
+
+    for (auto _ : state) {
+        Deserializer d(s.data());
+        u32 n = d.read_u32();
+        f32 sum = 0.0f;
+        for (u32 i = 0; i < n; ++i) {
+            d.read_u32();
+            sum += d.read_vec2f().x;
+            sum += d.read_vec2f().y;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<i64>(s.size()));
+}
+BENCHMARK(BM_DeserializeEntityRecords)->Apply(bench::message_sizes);
+
+// arg = string length in bytes
+static void BM_SerializeString(benchmark::State& state) {
+    std::string text(static_cast<size_t>(state.range(0)), 'x');
+    for (auto _ : state) {
+        Serializer s;
+        s.write_string(text);
+        benchmark::DoNotOptimize(s.data().data());
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SerializeString)->RangeMultiplier(8)->Range(16, 64 << 10);
@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+"""Compare two Google Benchmark JSON files and flag regressions.
+
+Usage: compare.py BASELINE.json CURRENT.json [--threshold PERCENT] [--metric cpu_time|real_time]
+
+Uses the mean aggregate when the run has repetitions, otherwise the single iteration result.
+Exits with status 1 if any benchmark is slower than the baseline by more than the threshold.
+"""
+
+import argparse
+import json
+import os
+import sys
+
+
+def load(path, metric):
+    with open(path) as f:
+        data = json.load(f)
+
+    results = {}
+    for bench in data.get("benchmarks", []):
+        if bench.get("error_occurred"):
+            continue
+        aggregate = bench.get("aggregate_name")
+        if aggregate is not None and aggregate != "mean":
+            continue
+        name = bench.get("run_name", bench["name"])
+        # Prefer the mean over individual repetitions of the same benchmark
+        if name in results and aggregate is None:
+            continue
+        results[name] = float(bench[metric])
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="allowed slowdown in percent (default: 10)")
+    parser.add_argument("--metric", default="cpu_time", choices=["cpu_time", "real_time"])
+    args = parser.parse_args()
+
+    if not os.path.exists(args.baseline):
+        sys.exit(f"no baseline at {args.baseline}; build the bench_baseline target first")
+
+    baseline = load(args.baseline, args.metric)
+    current = load(args.current, args.metric)
+
+    regressions = []
+    width = max((len(name) for name in current), default=0)
+    for name, time in sorted(current.items()):
+        base = baseline.get(name)
+        if base is None:
+            print(f"{name:<{width}}  {'new':>10}")
+            continue
+        change = (time - base) / base * 100.0 if base > 0 else 0.0
+        flag = ""
+        if change > args.threshold:
+            flag = "  REGRESSION"
+            regressions.append(name)
+        print(f"{name:<{width}}  {change:+9.1f}%{flag}")
+
+    for name in sorted(set(baseline) - set(current)):
+        print(f"{name:<{width}}  {'missing':>10}")
+
+    if regressions:
+        print(f"\n{len(regressions)} benchmark(s) regressed by more than {args.threshold:g}%")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
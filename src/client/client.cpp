@@ -7,6 +7,7 @@
 #include "net/content_downloader.hpp"
 #include "core/game/components/transform.hpp"
 #include "core/game/components/player.hpp"
+#include "core/net/compression.hpp"
 #include "server/server.hpp"
 
 #include <SDL3/SDL.h>
@@ -331,6 +332,9 @@ void Client::process_network() {
             case net::MessageType::DeltaState:
                 handle_delta_state(*msg);
                 break;
+            case net::MessageType::ChunkData:
+                handle_chunk_data(*msg);
+                break;
             default:
                 break;
         }
@@ -468,6 +472,16 @@ void Client::handle_entity_despawn(const net::Message& msg) {
     }
 }
 
+void Client::handle_chunk_data(const net::Message& msg) {
+    // Replaces the local copies of the chunks; the server only sends chunks we don't have yet
+    std::vector<u8> body = net::unpack_payload(msg.payload());
+    Deserializer reader{body};
+    u16 count = reader.read_u16();
+    for (u16 i = 0; i < count; ++i) {
+        tilemap_.deserialize_chunk(reader);
+    }
+}
+
 void Client::handle_delta_state(const net::Message& msg) {
     auto reader = msg.reader();
 
@@ -539,10 +553,9 @@ void Client::handle_delta_state(const net::Message& msg) {
         }
     }
 
-    // Reconcile local player prediction
-    if (!server_states.empty()) {
-        prediction_->on_server_state(tick, server_states);
-    }
+    // Reconcile local player prediction. The server only sends entities that changed,
+    // so an idle local player may be absent; still acknowledge the tick's inputs.
+    prediction_->on_server_state(tick, server_states);
 }
 
 void Client::handle_entity_update(const net::Message& msg) {
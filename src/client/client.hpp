@@ -100,6 +100,7 @@ private:
     void handle_entity_despawn(const net::Message& msg);
     void handle_entity_update(const net::Message& msg);
     void handle_delta_state(const net::Message& msg);
+    void handle_chunk_data(const net::Message& msg);
     void send_input();
 };
 
@@ -0,0 +1,128 @@
+#include "command_buffer.hpp"
+#include <atomic>
+
+namespace city {
+
+void CommandBuffer::clear() {
+    pending_creates_ = 0;
+    next_seq_ = 0;
+    created_.clear();
+    for (auto& batch : add_batches_) {
+        if (batch) batch->clear();
+    }
+    removes_.clear();
+    destroys_.clear();
+}
+
+CommandQueue::CommandQueue() {
+    static std::atomic<u64> next_id{1};
+    id_ = next_id++;
+}
+
+CommandBuffer& CommandQueue::local() {
+    // Single-entry cache so the common case (same thread, same queue) skips the lock
+    thread_local u64 cached_queue = 0;
+    thread_local CommandBuffer* cached_buffer = nullptr;
+    if (cached_queue == id_) {
+        return *cached_buffer;
+    }
+
+    std::lock_guard lock(mutex_);
+    auto& buffer = buffers_[std::this_thread::get_id()];
+    if (!buffer) {
+        buffer = std::make_unique<CommandBuffer>();
+    }
+    cached_queue = id_;
+    cached_buffer = buffer.get();
+    return *buffer;
+}
+
+void CommandQueue::flush(World& world) {
+    // Take the recorded commands out under the lock and apply them without it: handlers fired
+    // by the flush may record into (or lazily create) live buffers, which must not touch what
+    // is being applied
+    std::vector<std::unique_ptr<CommandBuffer>> flushing;
+    {
+        std::lock_guard lock(mutex_);
+        for (auto& [thread, buffer] : buffers_) {
+            if (buffer->empty()) continue;
+            std::unique_ptr<CommandBuffer> taken;
+            if (spares_.empty()) {
+                taken = std::make_unique<CommandBuffer>();
+            } else {
+                taken = std::move(spares_.back());
+                spares_.pop_back();
+            }
+            // Swap contents, not pointers: threads cache their live buffer's address
+            std::swap(*taken, *buffer);
+            flushing.push_back(std::move(taken));
+        }
+    }
+    if (flushing.empty()) return;
+
+    std::vector<CommandBuffer*> buffers;
+    buffers.reserve(flushing.size());
+    for (auto& buffer : flushing) {
+        buffers.push_back(buffer.get());
+    }
+
+    // Destroy set, sorted and deduplicated, so other commands can skip dying entities
+    std::vector<Entity> dying;
+    for (CommandBuffer* buffer : buffers) {
+        for (Entity e : buffer->destroys_) {
+            if (world.is_alive(e)) dying.push_back(e);
+        }
+    }
+    auto by_index = [](Entity a, Entity b) { return a.index < b.index; };
+    std::sort(dying.begin(), dying.end(), by_index);
+    dying.erase(std::unique(dying.begin(), dying.end()), dying.end());
+
+    // 1. Creates
+    for (CommandBuffer* buffer : buffers) {
+        buffer->created_.resize(buffer->pending_creates_);
+        world.create_many(buffer->created_);
+    }
+
+    // 2. Removes, grouped by type then entity
+    std::vector<std::pair<Entity, ComponentTypeId>> removes;
+    for (CommandBuffer* buffer : buffers) {
+        for (const auto& remove : buffer->removes_) {
+            removes.emplace_back(remove.entity, remove.type);
+        }
+    }
+    std::sort(removes.begin(), removes.end(), [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second < b.second : a.first.index < b.first.index;
+    });
+    removes.erase(std::unique(removes.begin(), removes.end()), removes.end());
+    for (const auto& [e, type] : removes) {
+        if (std::binary_search(dying.begin(), dying.end(), e, by_index)) continue;
+        world.remove_component(e, type);
+    }
+
+    // 3. Adds, one batch per component type across all buffers
+    size_t type_count = 0;
+    for (CommandBuffer* buffer : buffers) {
+        type_count = std::max(type_count, buffer->add_appliers_.size());
+    }
+    for (size_t id = 0; id < type_count; ++id) {
+        for (CommandBuffer* buffer : buffers) {
+            if (id < buffer->add_appliers_.size() && buffer->add_appliers_[id]) {
+                buffer->add_appliers_[id](world, buffers, static_cast<ComponentTypeId>(id), dying);
+                break;
+            }
+        }
+    }
+
+    // 4. Destroys
+    world.destroy_many(dying);
+
+    for (auto& buffer : flushing) {
+        buffer->clear();
+    }
+    std::lock_guard lock(mutex_);
+    for (auto& buffer : flushing) {
+        spares_.push_back(std::move(buffer));
+    }
+}
+
+} // namespace city
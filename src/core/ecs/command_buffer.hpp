@@ -0,0 +1,209 @@
+#pragma once
+
+#include "world.hpp"
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace city {
+
+// Placeholder for an entity created through a CommandBuffer.
+// Only meaningful inside the buffer that created it, until the next flush.
+struct PendingEntity {
+    u32 index;
+};
+
+// Records structural changes (create/destroy, add/remove component) for later application.
+// Safe to record into while iterating or from job system workers, as long as each thread
+// uses its own buffer (see CommandQueue::local / World::commands).
+// Adds and removes of one component on one entity take effect in recording order, so
+// remove_component<T>(e) followed by add_component<T>(e, v) leaves e with a fresh T.
+class CommandBuffer {
+public:
+    // Deferred create; the placeholder can receive components from this same buffer
+    PendingEntity create() { return PendingEntity{pending_creates_++}; }
+
+    void destroy(Entity e) { destroys_.push_back(e); }
+
+    template<typename T>
+    void add_component(Entity e, T component = T{}) {
+        batch<T>().adds.push_back({Target{e.index, e.generation, false, next_seq_++},
+                                   std::move(component)});
+    }
+
+    template<typename T>
+    void add_component(PendingEntity e, T component = T{}) {
+        batch<T>().adds.push_back({Target{e.index, 0, true, next_seq_++}, std::move(component)});
+    }
+
+    template<typename T>
+    void remove_component(Entity e) {
+        removes_.push_back({e, component_type_id<T>(), next_seq_++});
+    }
+
+    bool empty() const {
+        return pending_creates_ == 0 && destroys_.empty() && removes_.empty() &&
+               std::all_of(add_batches_.begin(), add_batches_.end(),
+                           [](const auto& b) { return !b || b->empty(); });
+    }
+
+    // Drop all recorded commands (keeps allocated capacity)
+    void clear();
+
+private:
+    friend class CommandQueue;
+
+    struct Target {
+        u32 index;          // Entity index, or PendingEntity index if pending
+        u32 generation;
+        bool pending;
+        u32 seq;            // Recording order within the buffer
+    };
+
+    struct Remove {
+        Entity entity;
+        ComponentTypeId type;
+        u32 seq;
+    };
+
+    class IComponentBatch {
+    public:
+        virtual ~IComponentBatch() = default;
+        virtual bool empty() const = 0;
+        virtual void clear() = 0;
+    };
+
+    template<typename T>
+    class ComponentBatch final : public IComponentBatch {
+    public:
+        bool empty() const override { return adds.empty(); }
+        void clear() override { adds.clear(); }
+
+        std::vector<std::pair<Target, T>> adds;
+    };
+
+    template<typename T>
+    ComponentBatch<T>& batch() {
+        ComponentTypeId id = component_type_id<T>();
+        if (id >= add_batches_.size()) {
+            add_batches_.resize(static_cast<size_t>(id) + 1);
+        }
+        auto& slot = add_batches_[id];
+        if (!slot) {
+            slot = std::make_unique<ComponentBatch<T>>();
+            add_appliers_.resize(add_batches_.size());
+            add_appliers_[id] = &apply_adds<T>;
+        }
+        return static_cast<ComponentBatch<T>&>(*slot);
+    }
+
+    // Applies one component type's adds from every buffer in a flush
+    using ApplyAdds = void (*)(World& world, std::span<CommandBuffer* const> buffers,
+                               ComponentTypeId id, const std::vector<Entity>& dying);
+
+    template<typename T>
+    static void apply_adds(World& world, std::span<CommandBuffer* const> buffers,
+                           ComponentTypeId id, const std::vector<Entity>& dying);
+
+    u32 pending_creates_{0};
+    u32 next_seq_{0};
+    std::vector<Entity> created_;   // Filled during flush: PendingEntity index -> Entity
+    std::vector<std::unique_ptr<IComponentBatch>> add_batches_;     // Indexed by ComponentTypeId
+    std::vector<ApplyAdds> add_appliers_;                           // Indexed by ComponentTypeId
+    std::vector<Remove> removes_;
+    std::vector<Entity> destroys_;
+};
+
+// Set of per-thread CommandBuffers flushed together at a sync point.
+//
+// Flush applies everything in batches, in a fixed order:
+//   1. creates, 2. component removes, 3. component adds (per type, sorted by entity,
+//   last write wins), 4. destroys.
+// Within one buffer that matches recording order per entity and component: an add recorded
+// after a remove re-adds the component (on_destroy, then on_construct), and an add recorded
+// before a later remove of the same component is dropped. Buffers of different threads are
+// unordered relative to each other; where they disagree, the add wins.
+// Adds and removes aimed at entities destroyed in the same flush are skipped, and
+// duplicate removes/destroys are coalesced.
+//
+// Flush takes the recorded commands out of the live buffers before applying them, so signal
+// handlers that fire during the flush can record into World::commands(); those commands
+// apply at the next flush.
+class CommandQueue {
+public:
+    CommandQueue();
+
+    // Buffer owned by the calling thread (created on first use)
+    CommandBuffer& local();
+
+    // Apply and clear all buffers. Must not run concurrently with recording on other threads.
+    void flush(World& world);
+
+private:
+    u64 id_;
+    std::mutex mutex_;
+    std::unordered_map<std::thread::id, std::unique_ptr<CommandBuffer>> buffers_;
+    std::vector<std::unique_ptr<CommandBuffer>> spares_;   // Emptied buffers, swapped in at flush
+};
+
+template<typename T>
+void CommandBuffer::apply_adds(World& world, std::span<CommandBuffer* const> buffers,
+                               ComponentTypeId id, const std::vector<Entity>& dying) {
+    std::vector<std::pair<Entity, T*>> adds;
+    std::vector<Remove> removed;    // This buffer's removes of T, by entity then seq
+    for (CommandBuffer* buffer : buffers) {
+        if (id >= buffer->add_batches_.size() || !buffer->add_batches_[id]) continue;
+
+        removed.clear();
+        for (const Remove& remove : buffer->removes_) {
+            if (remove.type == id) removed.push_back(remove);
+        }
+        std::sort(removed.begin(), removed.end(), [](const Remove& a, const Remove& b) {
+            return a.entity.index != b.entity.index ? a.entity.index < b.entity.index
+                                                    : a.seq < b.seq;
+        });
+
+        auto& batch = static_cast<ComponentBatch<T>&>(*buffer->add_batches_[id]);
+        for (auto& [target, component] : batch.adds) {
+            if (!target.pending && !removed.empty()) {
+                // Drop the add if this buffer removed the component afterwards
+                auto last = std::upper_bound(removed.begin(), removed.end(), target.index,
+                    [](u32 index, const Remove& r) { return index < r.entity.index; });
+                if (last != removed.begin() && std::prev(last)->entity.index == target.index &&
+                    std::prev(last)->entity.generation == target.generation &&
+                    std::prev(last)->seq > target.seq) {
+                    continue;
+                }
+            }
+            Entity e = target.pending ? buffer->created_[target.index]
+                                      : Entity{target.index, target.generation};
+            adds.emplace_back(e, &component);
+        }
+    }
+    if (adds.empty()) return;
+
+    // Sort by entity index so pool writes walk the sparse array in order; stable sort keeps
+    // recording order for duplicates so the last recorded value wins
+    std::stable_sort(adds.begin(), adds.end(), [](const auto& a, const auto& b) {
+        return a.first.index < b.first.index;
+    });
+
+    world.reserve_components<T>(adds.size());
+    for (size_t i = 0; i < adds.size(); ++i) {
+        if (i + 1 < adds.size() && adds[i + 1].first == adds[i].first) continue;
+
+        Entity e = adds[i].first;
+        if (!world.is_alive(e) || std::binary_search(dying.begin(), dying.end(), e,
+                [](Entity a, Entity b) { return a.index < b.index; })) {
+            continue;
+        }
+        world.add_component<T>(e, std::move(*adds[i].second));
+    }
+}
+
+} // namespace city
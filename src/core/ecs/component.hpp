@@ -1,32 +1,79 @@
 #pragma once
 
 #include "entity.hpp"
+#include "component_registry.hpp"
+#include <array>
+#include <memory>
 #include <vector>
 #include <optional>
+#include <stdexcept>
 #include <type_traits>
-#include <typeindex>
 
 namespace city {
 
-// Forward declarations
-class Serializer;
-class Deserializer;
+// Memory held by one component pool
+struct PoolMemoryStats {
+    size_t component_count{0};
+    size_t sparse_pages{0};     // Allocated sparse pages
+    size_t sparse_bytes{0};     // Sparse pages plus the page table
+    size_t dense_bytes{0};      // Reserved dense entries
 
-// Component type ID - assigned at runtime per component type
-using ComponentTypeId = u16;
-constexpr ComponentTypeId INVALID_COMPONENT_TYPE_ID = std::numeric_limits<u16>::max();
+    size_t total_bytes() const { return sparse_bytes + dense_bytes; }
+};
+
+// Type-erased interface shared by all component pools.
+// Lets World hold pools in a flat array indexed by ComponentTypeId.
+class IComponentPool {
+public:
+    virtual ~IComponentPool() = default;
+
+    // Component type stored in this pool
+    virtual ComponentTypeId type_id() const = 0;
+
+    // Check if entity has this component
+    virtual bool has(u32 entity_index) const = 0;
+
+    // Untyped access for tooling (pair with ComponentRegistry::info(type_id()))
+    virtual const void* get_erased(u32 entity_index) const = 0;
+
+    // Remove the component for an entity (no-op if absent)
+    virtual void remove(u32 entity_index) = 0;
+
+    // Remove all components
+    virtual void clear() = 0;
+
+    // Number of stored components
+    virtual size_t size() const = 0;
+
+    // Bytes and pages held by the pool's sparse and dense arrays
+    virtual PoolMemoryStats memory_stats() const = 0;
+
+    // Total bytes reserved by the pool
+    size_t memory_usage() const { return memory_stats().total_bytes(); }
+
+    // Create an empty pool of the same component type
+    virtual std::unique_ptr<IComponentPool> make_empty() const = 0;
+
+    // Become a copy of another pool of the same type, reusing this pool's allocations
+    // (used by world snapshots; dense entries of trivially copyable types are memcpy'd)
+    virtual void assign_from(const IComponentPool& other) = 0;
+};
 
 // Sparse set component storage
-// Provides O(1) access, add, remove while maintaining cache-friendly dense array
+// Provides O(1) access, add, remove while maintaining cache-friendly dense array.
+// The sparse side is split into fixed-size pages allocated on first use and freed when
+// their last component is removed, so memory follows the components actually stored
+// rather than the highest entity index.
 template<typename T>
-class ComponentPool {
+class ComponentPool final : public IComponentPool {
 public:
+    ComponentTypeId type_id() const override { return component_type_id<T>(); }
+
+    const void* get_erased(u32 entity_index) const override { return get(entity_index); }
+
     // Get component for entity (returns nullptr if not present)
     T* get(u32 entity_index) {
-        if (entity_index >= sparse_.size()) {
-            return nullptr;
-        }
-        u32 dense_index = sparse_[entity_index];
+        u32 dense_index = find(entity_index);
         if (dense_index == INVALID_INDEX) {
             return nullptr;
         }
@@ -34,10 +81,7 @@ public:
     }
 
     const T* get(u32 entity_index) const {
-        if (entity_index >= sparse_.size()) {
-            return nullptr;
-        }
-        u32 dense_index = sparse_[entity_index];
+        u32 dense_index = find(entity_index);
         if (dense_index == INVALID_INDEX) {
             return nullptr;
         }
@@ -45,37 +89,47 @@ public:
     }
 
     // Check if entity has this component
-    bool has(u32 entity_index) const {
-        return entity_index < sparse_.size() && sparse_[entity_index] != INVALID_INDEX;
-    }
-
-    // Add or replace component for entity
-    T& set(u32 entity_index, T component) {
-        // Ensure sparse array is large enough
-        if (entity_index >= sparse_.size()) {
-            sparse_.resize(entity_index + 1, INVALID_INDEX);
-        }
+    bool has(u32 entity_index) const override { return find(entity_index) != INVALID_INDEX; }
 
-        u32& dense_index = sparse_[entity_index];
+    // Add or replace component for entity, stamping it as changed at tick
+    T& set(u32 entity_index, T component, u32 tick = 0) {
+        // Allocates the sparse page on first use
+        SparsePage& page = page_for(entity_index);
+        u32& dense_index = page.dense_index[entity_index & PAGE_MASK];
         if (dense_index != INVALID_INDEX) {
             // Replace existing
             dense_[dense_index].component = std::move(component);
+            dense_[dense_index].changed_tick = tick;
             return dense_[dense_index].component;
         }
 
         // Add new
+        ++page.used;
         dense_index = static_cast<u32>(dense_.size());
-        dense_.push_back({entity_index, std::move(component)});
+        dense_.push_back({entity_index, tick, std::move(component)});
         return dense_.back().component;
     }
 
-    // Remove component from entity
-    void remove(u32 entity_index) {
-        if (entity_index >= sparse_.size()) {
-            return;
+    // Record that the entity's component was modified at tick (no-op if absent)
+    void mark_changed(u32 entity_index, u32 tick) {
+        u32 dense_index = find(entity_index);
+        if (dense_index != INVALID_INDEX) {
+            dense_[dense_index].changed_tick = tick;
         }
+    }
+
+    // Tick of the last add/replace/mark_changed (0 if absent)
+    u32 changed_tick(u32 entity_index) const {
+        u32 dense_index = find(entity_index);
+        return dense_index != INVALID_INDEX ? dense_[dense_index].changed_tick : 0;
+    }
+
+    // Reserve dense storage for additional components
+    void reserve(size_t additional) { dense_.reserve(dense_.size() + additional); }
 
-        u32 dense_index = sparse_[entity_index];
+    // Remove component from entity
+    void remove(u32 entity_index) override {
+        u32 dense_index = find(entity_index);
         if (dense_index == INVALID_INDEX) {
             return;
         }
@@ -86,11 +140,19 @@ public:
             // Move last element to removed position
             dense_[dense_index] = std::move(dense_[last_dense_index]);
             // Update sparse array for moved element
-            sparse_[dense_[dense_index].entity_index] = dense_index;
+            u32 moved = dense_[dense_index].entity_index;
+            pages_[moved >> PAGE_SHIFT]->dense_index[moved & PAGE_MASK] = dense_index;
         }
 
         dense_.pop_back();
-        sparse_[entity_index] = INVALID_INDEX;
+
+        // Free the page once its last component is gone
+        auto& page = pages_[entity_index >> PAGE_SHIFT];
+        page->dense_index[entity_index & PAGE_MASK] = INVALID_INDEX;
+        if (--page->used == 0) {
+            page.reset();
+            --page_count_;
+        }
     }
 
     // Iteration support
@@ -115,29 +177,105 @@ public:
         bool operator!=(const Iterator& other) const { return index != other.index; }
     };
 
+    // Positional access into the dense array (0..size()-1), e.g. for splitting ranges
+    u32 entity_at(size_t dense_index) const { return dense_[dense_index].entity_index; }
+    T& component_at(size_t dense_index) { return dense_[dense_index].component; }
+    const T& component_at(size_t dense_index) const { return dense_[dense_index].component; }
+    u32 changed_tick_at(size_t dense_index) const { return dense_[dense_index].changed_tick; }
+
     Iterator begin() { return {this, 0}; }
     Iterator end() { return {this, dense_.size()}; }
 
     // Size
-    size_t size() const { return dense_.size(); }
+    size_t size() const override { return dense_.size(); }
     bool empty() const { return dense_.empty(); }
 
     // Clear all components
-    void clear() {
-        sparse_.clear();
+    void clear() override {
+        pages_.clear();
+        page_count_ = 0;
         dense_.clear();
     }
 
+    std::unique_ptr<IComponentPool> make_empty() const override {
+        return std::make_unique<ComponentPool>();
+    }
+
+    void assign_from(const IComponentPool& other) override {
+        if constexpr (std::is_copy_assignable_v<T>) {
+            const auto& src = static_cast<const ComponentPool&>(other);
+            pages_.resize(src.pages_.size());
+            for (size_t i = 0; i < pages_.size(); ++i) {
+                if (!src.pages_[i]) {
+                    pages_[i].reset();
+                } else if (pages_[i]) {
+                    *pages_[i] = *src.pages_[i];
+                } else {
+                    pages_[i] = std::make_unique<SparsePage>(*src.pages_[i]);
+                }
+            }
+            page_count_ = src.page_count_;
+            dense_ = src.dense_;
+        } else {
+            throw std::logic_error("ComponentPool: cannot copy a pool of non-copyable components");
+        }
+    }
+
+    PoolMemoryStats memory_stats() const override {
+        PoolMemoryStats stats;
+        stats.component_count = dense_.size();
+        stats.sparse_pages = page_count_;
+        stats.sparse_bytes = pages_.capacity() * sizeof(std::unique_ptr<SparsePage>) +
+                             page_count_ * sizeof(SparsePage);
+        stats.dense_bytes = dense_.capacity() * sizeof(Entry);
+        return stats;
+    }
+
+    // Entity indices covered by one sparse page
+    static constexpr u32 PAGE_SHIFT = 12;
+    static constexpr u32 PAGE_SIZE = 1u << PAGE_SHIFT;
+
 private:
     static constexpr u32 INVALID_INDEX = std::numeric_limits<u32>::max();
+    static constexpr u32 PAGE_MASK = PAGE_SIZE - 1;
+
+    struct SparsePage {
+        SparsePage() { dense_index.fill(INVALID_INDEX); }
+
+        std::array<u32, PAGE_SIZE> dense_index;   // (entity_index & PAGE_MASK) -> dense_index
+        u32 used{0};                              // Non-empty slots
+    };
+
+    // Dense index for entity, or INVALID_INDEX if absent
+    u32 find(u32 entity_index) const {
+        size_t page = entity_index >> PAGE_SHIFT;
+        if (page >= pages_.size() || !pages_[page]) {
+            return INVALID_INDEX;
+        }
+        return pages_[page]->dense_index[entity_index & PAGE_MASK];
+    }
+
+    SparsePage& page_for(u32 entity_index) {
+        size_t page = entity_index >> PAGE_SHIFT;
+        if (page >= pages_.size()) {
+            pages_.resize(page + 1);
+        }
+        if (!pages_[page]) {
+            pages_[page] = std::make_unique<SparsePage>();
+            ++page_count_;
+        }
+        return *pages_[page];
+    }
 
     struct Entry {
         u32 entity_index;
+        u32 changed_tick;   // Tick of the last write made through set/mark_changed
         T component;
     };
 
-    std::vector<u32> sparse_;     // entity_index -> dense_index
-    std::vector<Entry> dense_;    // Packed component storage
+    std::vector<std::unique_ptr<SparsePage>> pages_;  // entity_index >> PAGE_SHIFT -> page
+    size_t page_count_{0};                            // Non-null pages
+    std::vector<Entry> dense_;                        // Packed component storage
 };
 
 } // namespace city
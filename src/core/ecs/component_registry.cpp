@@ -0,0 +1,90 @@
+#include "component_registry.hpp"
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+namespace city {
+
+namespace {
+
+struct RegistryStorage {
+    std::mutex mutex;
+    std::deque<ComponentTypeInfo> types;  // Deque keeps references stable while growing
+};
+
+RegistryStorage& storage() {
+    static RegistryStorage instance;
+    return instance;
+}
+
+} // namespace
+
+const ComponentTypeInfo& ComponentRegistry::info(ComponentTypeId id) {
+    auto& reg = storage();
+    std::lock_guard lock(reg.mutex);
+    return reg.types.at(id);
+}
+
+size_t ComponentRegistry::count() {
+    auto& reg = storage();
+    std::lock_guard lock(reg.mutex);
+    return reg.types.size();
+}
+
+std::vector<const ComponentTypeInfo*> ComponentRegistry::all() {
+    auto& reg = storage();
+    std::lock_guard lock(reg.mutex);
+
+    std::vector<const ComponentTypeInfo*> result;
+    result.reserve(reg.types.size());
+    for (const auto& info : reg.types) {
+        result.push_back(&info);
+    }
+    return result;
+}
+
+ComponentTypeId ComponentRegistry::register_type(ComponentTypeInfo info) {
+    auto& reg = storage();
+    std::lock_guard lock(reg.mutex);
+
+    if (reg.types.size() >= INVALID_COMPONENT_TYPE_ID) {
+        throw std::length_error("too many component types registered");
+    }
+
+    info.id = static_cast<ComponentTypeId>(reg.types.size());
+    reg.types.push_back(std::move(info));
+    return reg.types.back().id;
+}
+
+std::string ComponentRegistry::demangle(const char* mangled) {
+    std::string name = mangled;
+
+#if defined(__GNUG__)
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(mangled, nullptr, nullptr, &status);
+    if (status == 0 && demangled) {
+        name = demangled;
+    }
+    std::free(demangled);
+#endif
+
+    // MSVC prefixes type names with "struct " / "class "
+    for (std::string_view prefix : {"struct ", "class "}) {
+        if (name.starts_with(prefix)) {
+            name.erase(0, prefix.size());
+        }
+    }
+
+    constexpr std::string_view ns = "city::";
+    if (name.starts_with(ns)) {
+        name.erase(0, ns.size());
+    }
+    return name;
+}
+
+} // namespace city
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "core/util/types.hpp"
+#include "core/net/serialization.hpp"
+#include <limits>
+#include <string>
+#include <string_view>
+#include <typeinfo>
+#include <vector>
+
+namespace city {
+
+// Component type ID - dense, assigned at runtime the first time a type is seen
+using ComponentTypeId = u16;
+constexpr ComponentTypeId INVALID_COMPONENT_TYPE_ID = std::numeric_limits<u16>::max();
+
+// Per-type metadata recorded by the registry
+struct ComponentTypeInfo {
+    ComponentTypeId id{INVALID_COMPONENT_TYPE_ID};
+    std::string name;               // Demangled type name, without the city:: prefix
+    size_t size{0};
+    size_t alignment{0};
+
+    // Serialization hooks (null if the type isn't Serializable)
+    void (*serialize)(const void* component, Serializer& s){nullptr};
+    void (*deserialize)(void* component, Deserializer& d){nullptr};
+
+    bool is_serializable() const { return serialize != nullptr && deserialize != nullptr; }
+};
+
+// Process-wide registry of component types.
+// IDs are dense (0, 1, 2, ...) so per-type storage can live in flat arrays.
+// Registration happens lazily and is thread-safe; IDs are stable for the process lifetime
+// but depend on first-use order, so never send them over the network.
+class ComponentRegistry {
+public:
+    // Get (registering on first use) the ID for a component type
+    template<typename T>
+    static ComponentTypeId id() {
+        static const ComponentTypeId type_id = register_type(make_info<T>());
+        return type_id;
+    }
+
+    // Metadata for a registered type
+    static const ComponentTypeInfo& info(ComponentTypeId id);
+
+    template<typename T>
+    static const ComponentTypeInfo& info() {
+        return info(id<T>());
+    }
+
+    // Number of registered types (valid IDs are 0..count()-1)
+    static size_t count();
+
+    // Snapshot of all registered types, ordered by ID
+    static std::vector<const ComponentTypeInfo*> all();
+
+private:
+    template<typename T>
+    static ComponentTypeInfo make_info() {
+        ComponentTypeInfo info;
+        info.name = demangle(typeid(T).name());
+        info.size = sizeof(T);
+        info.alignment = alignof(T);
+        if constexpr (Serializable<T>) {
+            info.serialize = [](const void* component, Serializer& s) {
+                static_cast<const T*>(component)->serialize(s);
+            };
+            info.deserialize = [](void* component, Deserializer& d) {
+                static_cast<T*>(component)->deserialize(d);
+            };
+        }
+        return info;
+    }
+
+    static ComponentTypeId register_type(ComponentTypeInfo info);
+    static std::string demangle(const char* mangled);
+};
+
+// Shorthand for ComponentRegistry::id<T>()
+template<typename T>
+ComponentTypeId component_type_id() {
+    return ComponentRegistry::id<T>();
+}
+
+} // namespace city
@@ -24,9 +24,19 @@ struct Entity {
     bool operator!=(Entity other) const { return !(*this == other); }
 };
 
-// Network-stable entity ID (assigned by server, same across all clients)
+// Network-stable entity ID (assigned by server, same across all clients).
+// Low NET_ID_SLOT_BITS are a dense slot, the rest a generation bumped when the slot is
+// recycled, so stale IDs held by clients never resolve to a newer entity.
 using NetEntityId = u32;
 constexpr NetEntityId INVALID_NET_ENTITY_ID = 0;
+constexpr u32 NET_ID_SLOT_BITS = 20;
+constexpr u32 NET_ID_SLOT_MASK = (1u << NET_ID_SLOT_BITS) - 1;
+
+constexpr u32 net_id_slot(NetEntityId net_id) { return net_id & NET_ID_SLOT_MASK; }
+constexpr u32 net_id_generation(NetEntityId net_id) { return net_id >> NET_ID_SLOT_BITS; }
+constexpr NetEntityId make_net_id(u32 slot, u32 generation) {
+    return (generation << NET_ID_SLOT_BITS) | (slot & NET_ID_SLOT_MASK);
+}
 
 } // namespace city
 
@@ -0,0 +1,67 @@
+#include "scheduler.hpp"
+#include "core/util/job_system.hpp"
+#include <chrono>
+
+namespace city {
+
+void SystemScheduler::build_stages(std::span<const std::unique_ptr<System>> systems) {
+    access_.clear();
+    stage_of_.assign(systems.size(), 0);
+    for (auto& stage : stages_) {
+        stage.clear();
+    }
+
+    size_t stage_count = 0;
+    for (size_t i = 0; i < systems.size(); ++i) {
+        access_.push_back(systems[i]->access());
+
+        // Edge j -> i for every earlier conflicting system; run after the latest of them
+        for (size_t j = 0; j < i; ++j) {
+            if (access_[j].conflicts_with(access_[i])) {
+                stage_of_[i] = std::max(stage_of_[i], stage_of_[j] + 1);
+            }
+        }
+
+        u32 stage = stage_of_[i];
+        if (stage >= stages_.size()) {
+            stages_.resize(static_cast<size_t>(stage) + 1);
+        }
+        stages_[stage].push_back(static_cast<u32>(i));
+        stage_count = std::max(stage_count, static_cast<size_t>(stage) + 1);
+    }
+    stages_.resize(stage_count);
+}
+
+void SystemScheduler::run(World& world, std::span<const std::unique_ptr<System>> systems, f32 dt,
+                          JobSystem* jobs) {
+    build_stages(systems);
+    timings_.resize(systems.size());
+
+    auto run_system = [&](u32 index) {
+        auto start = std::chrono::high_resolution_clock::now();
+        systems[index]->update(world, dt);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        timings_[index] = SystemTiming{
+            systems[index]->name(),
+            std::chrono::duration<f64, std::micro>(end - start).count(),
+            stage_of_[index]
+        };
+    };
+
+    for (const auto& stage : stages_) {
+        if (jobs && stage.size() > 1) {
+            jobs->parallel_for(stage.size(), 1, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    run_system(stage[i]);
+                }
+            });
+        } else {
+            for (u32 index : stage) {
+                run_system(index);
+            }
+        }
+    }
+}
+
+} // namespace city
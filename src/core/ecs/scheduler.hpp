@@ -0,0 +1,45 @@
+#pragma once
+
+#include "system.hpp"
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace city {
+
+class JobSystem;
+
+// Wall time spent in one system during the last run
+struct SystemTiming {
+    std::string_view name;
+    f64 time_us{0.0};
+    u32 stage{0};           // Systems in the same stage ran concurrently
+};
+
+// Runs systems according to their declared SystemAccess.
+// Each run builds a dependency DAG in insertion order: a system depends on every earlier
+// system it conflicts with. Systems are grouped into stages by longest dependency chain,
+// and the systems of one stage run concurrently on the job system.
+class SystemScheduler {
+public:
+    // Run every system once. With jobs == nullptr, systems run sequentially in stage order.
+    void run(World& world, std::span<const std::unique_ptr<System>> systems, f32 dt,
+             JobSystem* jobs);
+
+    // Per-system timings from the last run (same order as the systems)
+    const std::vector<SystemTiming>& timings() const { return timings_; }
+
+    // Number of stages in the last run
+    size_t stage_count() const { return stages_.size(); }
+
+private:
+    void build_stages(std::span<const std::unique_ptr<System>> systems);
+
+    std::vector<SystemAccess> access_;          // Per system, refreshed each run
+    std::vector<u32> stage_of_;                 // Per system
+    std::vector<std::vector<u32>> stages_;      // Stage -> system indices
+    std::vector<SystemTiming> timings_;
+};
+
+} // namespace city
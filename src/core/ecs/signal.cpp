@@ -0,0 +1,95 @@
+#include "signal.hpp"
+#include <algorithm>
+#include <iterator>
+
+namespace city {
+
+ComponentSignal::ConnectionId ComponentSignal::connect(Handler handler) {
+    if (iterating_.load(std::memory_order_relaxed) > 0) {
+        added_handlers_.emplace_back(next_id_, std::move(handler));
+        changed_ = true;
+    } else {
+        handlers_.emplace_back(next_id_, std::move(handler));
+    }
+    return next_id_++;
+}
+
+ComponentSignal::ConnectionId ComponentSignal::connect_deferred(BatchHandler handler) {
+    if (!pending_) {
+        // One buffer per thread of a default-sized job system; more threads just share
+        pending_count_ = static_cast<size_t>(JobSystem::default_worker_count()) + 1;
+        pending_ = std::make_unique<PendingBuffer[]>(pending_count_);
+    }
+    if (iterating_.load(std::memory_order_relaxed) > 0) {
+        added_batch_handlers_.emplace_back(next_id_, std::move(handler));
+        changed_ = true;
+    } else {
+        batch_handlers_.emplace_back(next_id_, std::move(handler));
+    }
+    return next_id_++;
+}
+
+void ComponentSignal::disconnect(ConnectionId id) {
+    auto matches = [id](const auto& entry) { return entry.first == id; };
+    if (iterating_.load(std::memory_order_relaxed) > 0) {
+        // A handler is running: mark the entry so the loop's elements stay where they are
+        for (auto& entry : handlers_) {
+            if (entry.first == id) entry.first = 0;
+        }
+        for (auto& entry : batch_handlers_) {
+            if (entry.first == id) entry.first = 0;
+        }
+        std::erase_if(added_handlers_, matches);
+        std::erase_if(added_batch_handlers_, matches);
+        changed_ = true;
+        return;
+    }
+
+    std::erase_if(handlers_, matches);
+    std::erase_if(batch_handlers_, matches);
+    if (batch_handlers_.empty()) clear_pending();
+}
+
+void ComponentSignal::apply_changes() {
+    changed_ = false;
+    auto disconnected = [](const auto& entry) { return entry.first == 0; };
+    std::erase_if(handlers_, disconnected);
+    std::erase_if(batch_handlers_, disconnected);
+    std::move(added_handlers_.begin(), added_handlers_.end(), std::back_inserter(handlers_));
+    std::move(added_batch_handlers_.begin(), added_batch_handlers_.end(),
+              std::back_inserter(batch_handlers_));
+    added_handlers_.clear();
+    added_batch_handlers_.clear();
+    if (batch_handlers_.empty()) clear_pending();
+}
+
+void ComponentSignal::clear_pending() {
+    for (size_t i = 0; i < pending_count_; ++i) {
+        std::lock_guard lock(pending_[i].mutex);
+        pending_[i].entities.clear();
+    }
+}
+
+void ComponentSignal::dispatch(World& world) {
+    for (size_t i = 0; i < pending_count_; ++i) {
+        PendingBuffer& buffer = pending_[i];
+        std::lock_guard lock(buffer.mutex);
+        dispatching_.insert(dispatching_.end(), buffer.entities.begin(), buffer.entities.end());
+        buffer.entities.clear();
+    }
+    if (dispatching_.empty()) return;
+
+    std::sort(dispatching_.begin(), dispatching_.end(), [](Entity a, Entity b) {
+        return a.index != b.index ? a.index < b.index : a.generation < b.generation;
+    });
+    dispatching_.erase(std::unique(dispatching_.begin(), dispatching_.end()), dispatching_.end());
+
+    begin_iteration();
+    for (size_t i = 0, count = batch_handlers_.size(); i < count; ++i) {
+        if (batch_handlers_[i].first != 0) batch_handlers_[i].second(world, dispatching_);
+    }
+    dispatching_.clear();
+    end_iteration();
+}
+
+} // namespace city
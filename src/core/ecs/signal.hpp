@@ -0,0 +1,103 @@
+#pragma once
+
+#include "entity.hpp"
+#include "core/util/job_system.hpp"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace city {
+
+class World;
+
+// Subscribers to one lifecycle event of one component type (see World::on_construct).
+//
+// Immediate handlers run inside the triggering call, on the calling thread, and must not
+// make structural changes (record them in World::commands() instead). Deferred handlers
+// receive every entity the event fired for since the last World::dispatch_signals(),
+// sorted and with duplicates removed; events may be queued from job system workers.
+// Each worker queues into its own buffer (by JobSystem::current_thread_index), so a parallel
+// pass stamping components doesn't serialise on one lock; the buffers are merged at
+// dispatch. Nothing is recorded while a signal has no subscribers.
+// Handlers may connect or disconnect (themselves included) while the signal is firing; those
+// changes take effect once no handler of this signal is running.
+class ComponentSignal {
+public:
+    using Handler = std::function<void(World&, Entity)>;
+    using BatchHandler = std::function<void(World&, std::span<const Entity>)>;
+    using ConnectionId = u32;
+
+    ConnectionId connect(Handler handler);
+
+    ConnectionId connect_deferred(BatchHandler handler);
+
+    void disconnect(ConnectionId id);
+
+    bool empty() const { return handlers_.empty() && batch_handlers_.empty(); }
+
+    // Fire the event for an entity (called by World)
+    void emit(World& world, Entity e) {
+        if (!handlers_.empty()) {
+            begin_iteration();
+            for (size_t i = 0, count = handlers_.size(); i < count; ++i) {
+                if (handlers_[i].first != 0) handlers_[i].second(world, e);
+            }
+            end_iteration();
+        }
+        if (!batch_handlers_.empty()) {
+            // Workers of one job system never share a buffer; the lock only matters when
+            // other threads (index 0, or a second job system) land on the same one
+            PendingBuffer& buffer = pending_[JobSystem::current_thread_index() % pending_count_];
+            std::lock_guard lock(buffer.mutex);
+            buffer.entities.push_back(e);
+        }
+    }
+
+    // Deliver queued events to deferred handlers (called by World::dispatch_signals)
+    void dispatch(World& world);
+
+private:
+    void begin_iteration() { iterating_.fetch_add(1, std::memory_order_relaxed); }
+    void end_iteration() {
+        if (iterating_.fetch_sub(1, std::memory_order_acq_rel) == 1 && changed_) apply_changes();
+    }
+
+    // Drop entries disconnected and add handlers connected while iterating
+    void apply_changes();
+    void clear_pending();
+
+    std::vector<std::pair<ConnectionId, Handler>> handlers_;                // Id 0: disconnected
+    std::vector<std::pair<ConnectionId, BatchHandler>> batch_handlers_;
+    ConnectionId next_id_{1};
+
+    // Handler lists are never resized while a handler runs (emits may nest, and run on
+    // several workers at once); connections made meanwhile wait here
+    std::atomic<u32> iterating_{0};
+    bool changed_{false};
+    std::vector<std::pair<ConnectionId, Handler>> added_handlers_;
+    std::vector<std::pair<ConnectionId, BatchHandler>> added_batch_handlers_;
+
+    // Own cache line each, so workers queueing in parallel don't contend
+    struct alignas(64) PendingBuffer {
+        std::mutex mutex;
+        std::vector<Entity> entities;
+    };
+
+    // Allocated with the first deferred subscriber
+    std::unique_ptr<PendingBuffer[]> pending_;
+    size_t pending_count_{0};
+    std::vector<Entity> dispatching_;   // Batch being delivered (keeps capacity)
+};
+
+// Lifecycle signals of one component type
+struct ComponentSignals {
+    ComponentSignal construct;  // Component added to an entity that didn't have it
+    ComponentSignal update;     // Component replaced or marked changed
+    ComponentSignal destroy;    // Component about to be removed (directly or by destroy)
+};
+
+} // namespace city
@@ -1,12 +1,58 @@
 #pragma once
 
 #include "core/util/types.hpp"
+#include "component_registry.hpp"
+#include <algorithm>
+#include <string_view>
+#include <vector>
 
 namespace city {
 
 // Forward declaration
 class World;
 
+// Components a system reads and writes during update().
+// The scheduler runs two systems concurrently only if neither writes what the other touches.
+struct SystemAccess {
+    std::vector<ComponentTypeId> reads;
+    std::vector<ComponentTypeId> writes;
+    bool exclusive{false};  // Conflicts with everything (structural changes, unknown access)
+
+    template<typename... Ts>
+    SystemAccess& read() {
+        (reads.push_back(component_type_id<Ts>()), ...);
+        return *this;
+    }
+
+    template<typename... Ts>
+    SystemAccess& write() {
+        (writes.push_back(component_type_id<Ts>()), ...);
+        return *this;
+    }
+
+    static SystemAccess exclusive_access() {
+        SystemAccess access;
+        access.exclusive = true;
+        return access;
+    }
+
+    bool conflicts_with(const SystemAccess& other) const {
+        if (exclusive || other.exclusive) return true;
+
+        auto touches = [](const SystemAccess& access, ComponentTypeId id) {
+            return std::find(access.reads.begin(), access.reads.end(), id) != access.reads.end() ||
+                   std::find(access.writes.begin(), access.writes.end(), id) != access.writes.end();
+        };
+        for (ComponentTypeId id : writes) {
+            if (touches(other, id)) return true;
+        }
+        for (ComponentTypeId id : other.writes) {
+            if (touches(*this, id)) return true;
+        }
+        return false;
+    }
+};
+
 // Base class for systems that operate on entities
 class System {
 public:
@@ -20,6 +66,14 @@ public:
 
     // Optional: called when system is removed from world
     virtual void on_removed(World& /*world*/) {}
+
+    // Components touched by update(). Systems that don't override this run exclusively.
+    // Systems that run concurrently must not create/destroy entities, add/remove
+    // components or create views inside update().
+    virtual SystemAccess access() const { return SystemAccess::exclusive_access(); }
+
+    // Display name for profiling; every system must name itself
+    virtual std::string_view name() const = 0;
 };
 
 // System execution context - determines where a system runs
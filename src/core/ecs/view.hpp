@@ -0,0 +1,117 @@
+#pragma once
+
+#include "entity.hpp"
+#include "component.hpp"
+#include "core/util/job_system.hpp"
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+namespace city {
+
+// Type-erased interface for persistent views (lets World notify views of any signature)
+class IView {
+public:
+    virtual ~IView() = default;
+
+    // Component type IDs this view was created for, in template order
+    virtual const std::vector<ComponentTypeId>& signature() const = 0;
+
+    // Called after a component of one of the view's types was added to an entity
+    virtual void on_component_added(Entity e) = 0;
+
+    // Called before a component of one of the view's types is removed from an entity
+    virtual void on_component_removed(Entity e) = 0;
+
+    // Recompute matches from scratch after the pools were replaced (e.g. snapshot restore)
+    virtual void rebuild(const std::vector<u32>& generations) = 0;
+};
+
+// Persistent query over entities that have all of Ts.
+// Keeps a packed list of matching entities that World updates on every add/remove/destroy,
+// so iterating costs O(matches) regardless of how large the individual pools are.
+// Created and owned by World (see World::view); references stay valid for the world's lifetime.
+template<typename... Ts>
+class View final : public IView {
+public:
+    explicit View(ComponentPool<Ts>&... pools)
+        : pools_(&pools...), signature_{component_type_id<Ts>()...} {}
+
+    const std::vector<ComponentTypeId>& signature() const override { return signature_; }
+
+    void on_component_added(Entity e) override {
+        if (contains(e.index)) return;
+        if (!(std::get<ComponentPool<Ts>*>(pools_)->has(e.index) && ...)) return;
+
+        if (e.index >= positions_.size()) {
+            positions_.resize(static_cast<size_t>(e.index) + 1, INVALID_INDEX);
+        }
+        positions_[e.index] = static_cast<u32>(entities_.size());
+        entities_.push_back(e);
+    }
+
+    void on_component_removed(Entity e) override {
+        if (!contains(e.index)) return;
+
+        // Swap with last element for O(1) removal
+        u32 position = positions_[e.index];
+        Entity last = entities_.back();
+        entities_[position] = last;
+        positions_[last.index] = position;
+
+        entities_.pop_back();
+        positions_[e.index] = INVALID_INDEX;
+    }
+
+    void rebuild(const std::vector<u32>& generations) override {
+        entities_.clear();
+        std::fill(positions_.begin(), positions_.end(), INVALID_INDEX);
+
+        auto* first = std::get<0>(pools_);
+        for (size_t i = 0; i < first->size(); ++i) {
+            u32 index = first->entity_at(i);
+            on_component_added(Entity{index, generations[index]});
+        }
+    }
+
+    // Check if an entity currently matches the view
+    bool contains(u32 entity_index) const {
+        return entity_index < positions_.size() && positions_[entity_index] != INVALID_INDEX;
+    }
+
+    // Matching entities (unordered)
+    const std::vector<Entity>& entities() const { return entities_; }
+    size_t size() const { return entities_.size(); }
+    bool empty() const { return entities_.empty(); }
+
+    // Call func(entity, Ts&...) for every matching entity.
+    // Structural changes (create/destroy/add/remove) must not happen inside func.
+    template<typename Func>
+    void each(Func&& func) {
+        for (Entity e : entities_) {
+            func(e, *std::get<ComponentPool<Ts>*>(pools_)->get(e.index)...);
+        }
+    }
+
+    // Parallel each(): matching entities are split across the job system.
+    // func may only touch the components it is handed (plus thread-safe shared state).
+    template<typename Func>
+    void par_each(JobSystem& jobs, Func&& func, size_t grain = 64) {
+        jobs.parallel_for(entities_.size(), grain, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                Entity e = entities_[i];
+                func(e, *std::get<ComponentPool<Ts>*>(pools_)->get(e.index)...);
+            }
+        });
+    }
+
+private:
+    static constexpr u32 INVALID_INDEX = std::numeric_limits<u32>::max();
+
+    std::tuple<ComponentPool<Ts>*...> pools_;
+    std::vector<ComponentTypeId> signature_;
+    std::vector<Entity> entities_;      // Packed matching entities
+    std::vector<u32> positions_;        // entity_index -> position in entities_
+};
+
+} // namespace city
@@ -1,8 +1,15 @@
 #include "world.hpp"
+#include "command_buffer.hpp"
+#include <algorithm>
 #include <stdexcept>
 
 namespace city {
 
+World::World() : commands_(std::make_unique<CommandQueue>()) {}
+World::~World() = default;
+World::World(World&&) noexcept = default;
+World& World::operator=(World&&) noexcept = default;
+
 Entity World::create() {
     u32 index;
     u32 generation;
@@ -23,31 +30,93 @@ Entity World::create() {
     return Entity{index, generation};
 }
 
+void World::create_many(std::span<Entity> out) {
+    size_t reused = std::min(out.size(), free_indices_.size());
+    generations_.reserve(generations_.size() + (out.size() - reused));
+
+    for (size_t i = 0; i < reused; ++i) {
+        u32 index = free_indices_.back();
+        free_indices_.pop_back();
+        out[i] = Entity{index, generations_[index]};
+    }
+    for (size_t i = reused; i < out.size(); ++i) {
+        out[i] = Entity{static_cast<u32>(generations_.size()), 0};
+        generations_.push_back(0);
+    }
+
+    alive_count_ += out.size();
+}
+
 void World::destroy(Entity e) {
     if (!is_alive(e)) return;
 
+    // Destroy signals fire while the entity and its components are still reachable
+    for (size_t id = 0; id < signals_.size(); ++id) {
+        if (signals_[id] && id < component_pools_.size() && component_pools_[id] &&
+            component_pools_[id]->has(e.index)) {
+            signals_[id]->destroy.emit(*this, e);
+        }
+    }
+
     // Increment generation to invalidate existing references
     ++generations_[e.index];
 
     // Remove all components
-    for (auto& [type, pool] : component_pools_) {
-        // We can't easily remove from std::any without knowing the type,
-        // so components will be cleaned up lazily when the slot is reused
-        // This is acceptable for our use case
+    for (auto& pool : component_pools_) {
+        if (pool && pool->has(e.index)) {
+            notify_views_removed(pool->type_id(), e);
+            pool->remove(e.index);
+        }
     }
 
     // Remove network ID mapping if present
-    auto net_it = entity_to_net_.find(e.index);
-    if (net_it != entity_to_net_.end()) {
-        net_to_entity_.erase(net_it->second);
-        entity_to_net_.erase(net_it);
-    }
+    release_net_id(e.index);
 
     // Add to free list for reuse
     free_indices_.push_back(e.index);
     --alive_count_;
 }
 
+void World::destroy_many(std::span<const Entity> entities) {
+    std::vector<Entity> dying;
+    dying.reserve(entities.size());
+    for (Entity e : entities) {
+        if (is_alive(e)) dying.push_back(e);
+    }
+    std::sort(dying.begin(), dying.end(), [](Entity a, Entity b) { return a.index < b.index; });
+    dying.erase(std::unique(dying.begin(), dying.end()), dying.end());
+
+    // Destroy signals fire while the entities and their components are still reachable
+    for (size_t id = 0; id < signals_.size(); ++id) {
+        if (!signals_[id] || id >= component_pools_.size() || !component_pools_[id]) continue;
+        for (Entity e : dying) {
+            if (component_pools_[id]->has(e.index)) signals_[id]->destroy.emit(*this, e);
+        }
+    }
+
+    for (Entity e : dying) {
+        ++generations_[e.index];
+    }
+
+    // One sweep per pool
+    for (auto& pool : component_pools_) {
+        if (!pool || pool->size() == 0) continue;
+        for (Entity e : dying) {
+            if (pool->has(e.index)) {
+                notify_views_removed(pool->type_id(), e);
+                pool->remove(e.index);
+            }
+        }
+    }
+
+    free_indices_.reserve(free_indices_.size() + dying.size());
+    for (Entity e : dying) {
+        release_net_id(e.index);
+        free_indices_.push_back(e.index);
+    }
+    alive_count_ -= dying.size();
+}
+
 bool World::is_alive(Entity e) const {
     if (e.index >= generations_.size()) return false;
     return generations_[e.index] == e.generation;
@@ -56,43 +125,205 @@ bool World::is_alive(Entity e) const {
 void World::assign_net_id(Entity e, NetEntityId net_id) {
     if (!is_alive(e)) return;
 
-    // Remove old mapping if exists
-    auto old_it = entity_to_net_.find(e.index);
-    if (old_it != entity_to_net_.end()) {
-        net_to_entity_.erase(old_it->second);
+    // Remove old mapping if exists (for the entity and for whoever held the slot)
+    release_net_id(e.index);
+    u32 slot = net_id_slot(net_id);
+    if (slot == 0) return;
+    if (slot >= net_slots_.size()) {
+        net_slots_.resize(static_cast<size_t>(slot) + 1);
+    }
+    if (net_slots_[slot].entity.is_valid()) {
+        entity_net_ids_[net_slots_[slot].entity.index] = INVALID_NET_ENTITY_ID;
     }
 
-    // Add new mapping
-    net_to_entity_[net_id] = e;
-    entity_to_net_[e.index] = net_id;
+    // Add new mapping (a slot still on the free list is skipped when allocating)
+    net_slots_[slot].entity = e;
+    net_slots_[slot].net_id = net_id;
+    if (e.index >= entity_net_ids_.size()) {
+        entity_net_ids_.resize(static_cast<size_t>(e.index) + 1, INVALID_NET_ENTITY_ID);
+    }
+    entity_net_ids_[e.index] = net_id;
 }
 
-Entity World::get_by_net_id(NetEntityId net_id) const {
-    auto it = net_to_entity_.find(net_id);
-    if (it == net_to_entity_.end()) {
-        return Entity::null();
+void World::release_net_id(u32 entity_index) {
+    if (entity_index >= entity_net_ids_.size()) return;
+    NetEntityId net_id = entity_net_ids_[entity_index];
+    if (net_id == INVALID_NET_ENTITY_ID) return;
+
+    entity_net_ids_[entity_index] = INVALID_NET_ENTITY_ID;
+    u32 slot = net_id_slot(net_id);
+    NetSlot& entry = net_slots_[slot];
+    entry.entity = Entity::null();
+    if (entry.allocated && !entry.free_listed) {
+        entry.free_listed = true;
+        free_net_slots_.push_back(slot);
     }
-    return it->second;
 }
 
-NetEntityId World::get_net_id(Entity e) const {
-    if (!is_alive(e)) return INVALID_NET_ENTITY_ID;
+void World::assign_new_net_ids(std::span<const Entity> entities) {
+    if (entities.empty()) return;
+
+    // Size both directions once for the whole batch
+    u32 max_index = 0;
+    for (Entity e : entities) {
+        if (is_alive(e)) max_index = std::max(max_index, e.index);
+    }
+    if (max_index >= entity_net_ids_.size()) {
+        entity_net_ids_.resize(static_cast<size_t>(max_index) + 1, INVALID_NET_ENTITY_ID);
+    }
+    net_slots_.reserve(net_slots_.size() + entities.size());
 
-    auto it = entity_to_net_.find(e.index);
-    if (it == entity_to_net_.end()) {
-        return INVALID_NET_ENTITY_ID;
+    for (Entity e : entities) {
+        if (is_alive(e)) assign_net_id(e, allocate_net_id());
     }
-    return it->second;
 }
 
 NetEntityId World::allocate_net_id() {
-    return next_net_id_++;
+    // Reuse a released slot that nobody re-claimed through assign_net_id
+    while (!free_net_slots_.empty()) {
+        u32 slot = free_net_slots_.back();
+        free_net_slots_.pop_back();
+        NetSlot& entry = net_slots_[slot];
+        entry.free_listed = false;
+        if (entry.entity.is_valid()) continue;   // Re-claimed through assign_net_id
+
+        // Bump the generation (wrapping) so IDs issued for the old occupant stay stale
+        u32 generation = (net_id_generation(entry.net_id) + 1) & (UINT32_MAX >> NET_ID_SLOT_BITS);
+        entry.net_id = make_net_id(slot, generation);
+        return entry.net_id;
+    }
+
+    // Fresh slot; keeps its ID in net_slots_ so it isn't handed out twice
+    u32 slot = static_cast<u32>(net_slots_.size());
+    if (slot > NET_ID_SLOT_MASK) {
+        throw std::length_error("World: out of network ID slots");
+    }
+    net_slots_.push_back(NetSlot{Entity::null(), make_net_id(slot, 0), true, false});
+    return net_slots_.back().net_id;
 }
 
-void World::update(f32 dt) {
-    for (auto& system : systems_) {
-        system->update(*this, dt);
+void World::remove_component(Entity e, ComponentTypeId id) {
+    if (!is_alive(e)) return;
+    IComponentPool* pool = get_pool(id);
+    if (pool && pool->has(e.index)) {
+        emit_destroy(id, e);
+        notify_views_removed(id, e);
+        pool->remove(e.index);
     }
 }
 
+namespace {
+
+// Make dst a copy of src, reusing existing pool objects where possible
+void copy_pools(const std::vector<std::unique_ptr<IComponentPool>>& src,
+                std::vector<std::unique_ptr<IComponentPool>>& dst) {
+    if (dst.size() < src.size()) {
+        dst.resize(src.size());
+    }
+    for (size_t id = 0; id < dst.size(); ++id) {
+        const IComponentPool* from = id < src.size() ? src[id].get() : nullptr;
+        if (!from) {
+            if (dst[id]) dst[id]->clear();
+            continue;
+        }
+        if (!dst[id]) {
+            dst[id] = from->make_empty();
+        }
+        dst[id]->assign_from(*from);
+    }
+}
+
+} // namespace
+
+void World::save_snapshot(WorldSnapshot& snapshot) const {
+    snapshot.generations_ = generations_;
+    snapshot.free_indices_ = free_indices_;
+    snapshot.alive_count_ = alive_count_;
+    copy_pools(component_pools_, snapshot.pools_);
+    snapshot.net_slots_ = net_slots_;
+    snapshot.entity_net_ids_ = entity_net_ids_;
+    snapshot.free_net_slots_ = free_net_slots_;
+    snapshot.saved_ = true;
+}
+
+void World::restore_snapshot(const WorldSnapshot& snapshot) {
+    if (!snapshot.saved_) return;
+
+    generations_ = snapshot.generations_;
+    free_indices_ = snapshot.free_indices_;
+    alive_count_ = snapshot.alive_count_;
+    copy_pools(snapshot.pools_, component_pools_);
+    net_slots_ = snapshot.net_slots_;
+    entity_net_ids_ = snapshot.entity_net_ids_;
+    free_net_slots_ = snapshot.free_net_slots_;
+
+    // Views track matches incrementally, so recompute them against the restored pools
+    for (auto& v : views_) {
+        v->rebuild(generations_);
+    }
+}
+
+size_t WorldSnapshot::memory_usage() const {
+    size_t total = 0;
+    for (const auto& pool : pools_) {
+        if (pool) {
+            total += pool->memory_usage();
+        }
+    }
+    return total;
+}
+
+ComponentSignals& World::signals_for(ComponentTypeId id) {
+    if (id >= signals_.size()) {
+        signals_.resize(static_cast<size_t>(id) + 1);
+    }
+    if (!signals_[id]) {
+        signals_[id] = std::make_unique<ComponentSignals>();
+    }
+    return *signals_[id];
+}
+
+void World::dispatch_signals() {
+    // Index loop: deferred handlers may subscribe to further types
+    for (size_t id = 0; id < signals_.size(); ++id) {
+        if (auto* signals = signals_[id].get()) {
+            signals->construct.dispatch(*this);
+            signals->update.dispatch(*this);
+            signals->destroy.dispatch(*this);
+        }
+    }
+}
+
+CommandBuffer& World::commands() {
+    return commands_->local();
+}
+
+void World::flush_commands() {
+    commands_->flush(*this);
+}
+
+size_t World::component_memory_usage() const {
+    size_t total = 0;
+    for (const auto& pool : component_pools_) {
+        if (pool) {
+            total += pool->memory_usage();
+        }
+    }
+    return total;
+}
+
+std::vector<World::PoolMemoryReport> World::component_memory_report() const {
+    std::vector<PoolMemoryReport> report;
+    for (const auto& pool : component_pools_) {
+        if (pool) {
+            report.push_back({ComponentRegistry::info(pool->type_id()).name, pool->memory_stats()});
+        }
+    }
+    return report;
+}
+
+void World::update(f32 dt) {
+    scheduler_.run(*this, systems_, dt, jobs_);
+}
+
 } // namespace city
@@ -3,34 +3,57 @@
 #include "entity.hpp"
 #include "component.hpp"
 #include "system.hpp"
+#include "scheduler.hpp"
+#include "view.hpp"
+#include "signal.hpp"
+#include "core/util/job_system.hpp"
 #include <vector>
-#include <unordered_map>
+#include <algorithm>
 #include <memory>
-#include <any>
-#include <typeindex>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <utility>
 
 namespace city {
 
+class CommandBuffer;
+class CommandQueue;
+class WorldSnapshot;
+
 // The World manages all entities, components, and systems
 class World {
 public:
-    World() = default;
-    ~World() = default;
+    World();
+    ~World();
 
     // Non-copyable, movable
     World(const World&) = delete;
     World& operator=(const World&) = delete;
-    World(World&&) = default;
-    World& operator=(World&&) = default;
+    World(World&&) noexcept;
+    World& operator=(World&&) noexcept;
 
     // ========== Entity Management ==========
 
     // Create a new entity
     Entity create();
 
+    // Create entities into out (one reservation for the whole batch)
+    void create_many(std::span<Entity> out);
+
+    std::vector<Entity> create_many(size_t count) {
+        std::vector<Entity> entities(count);
+        create_many(entities);
+        return entities;
+    }
+
     // Destroy an entity and all its components
     void destroy(Entity e);
 
+    // Destroy many entities: one pass per component pool instead of one per entity.
+    // Dead and duplicate handles are ignored.
+    void destroy_many(std::span<const Entity> entities);
+
     // Check if an entity is still alive
     bool is_alive(Entity e) const;
 
@@ -39,11 +62,10 @@ public:
 
     // ========== Component Management ==========
 
-    // Add a component to an entity
+    // Add a component to an entity (stamped as changed at change_tick())
     template<typename T>
     T& add_component(Entity e, T component = T{}) {
-        auto& pool = get_or_create_pool<T>();
-        return pool.set(e.index, std::move(component));
+        return add_to_pool(get_or_create_pool<T>(), e, std::move(component));
     }
 
     // Get a component from an entity (returns nullptr if not present)
@@ -63,6 +85,39 @@ public:
         return pool->get(e.index);
     }
 
+    // Get a component for writing: stamps it as changed at change_tick()
+    template<typename T>
+    T* get_mut(Entity e) {
+        if (!is_alive(e)) return nullptr;
+        auto* pool = get_pool<T>();
+        if (!pool) return nullptr;
+        T* component = pool->get(e.index);
+        if (component) {
+            pool->mark_changed(e.index, change_tick_);
+            emit_update(component_type_id<T>(), e);
+        }
+        return component;
+    }
+
+    // Stamp a component as changed at change_tick() after writing it through get_component
+    template<typename T>
+    void mark_changed(Entity e) {
+        if (!is_alive(e)) return;
+        auto* pool = get_pool<T>();
+        if (pool && pool->has(e.index)) {
+            pool->mark_changed(e.index, change_tick_);
+            emit_update(component_type_id<T>(), e);
+        }
+    }
+
+    // Tick at which the entity's component last changed (0 if absent)
+    template<typename T>
+    u32 changed_tick(Entity e) const {
+        if (!is_alive(e)) return 0;
+        auto* pool = get_pool<T>();
+        return pool ? pool->changed_tick(e.index) : 0;
+    }
+
     // Check if entity has a component
     template<typename T>
     bool has_component(Entity e) const {
@@ -71,45 +126,158 @@ public:
         return pool && pool->has(e.index);
     }
 
+    // Add components[i] to entities[i] for every i, reserving pool capacity once.
+    // Behaves like add_component per entity (views, change ticks, signals).
+    template<typename T>
+    void add_components_bulk(std::span<const Entity> entities, std::span<const T> components) {
+        auto& pool = get_or_create_pool<T>();
+        pool.reserve(entities.size());
+        size_t count = std::min(entities.size(), components.size());
+        for (size_t i = 0; i < count; ++i) {
+            if (is_alive(entities[i])) add_to_pool(pool, entities[i], components[i]);
+        }
+    }
+
+    // Add the same component value to every entity
+    template<typename T>
+    void add_components_bulk(std::span<const Entity> entities, const T& component = T{}) {
+        auto& pool = get_or_create_pool<T>();
+        pool.reserve(entities.size());
+        for (Entity e : entities) {
+            if (is_alive(e)) add_to_pool(pool, e, component);
+        }
+    }
+
     // Remove a component from an entity
     template<typename T>
     void remove_component(Entity e) {
         if (!is_alive(e)) return;
         auto* pool = get_pool<T>();
-        if (pool) {
+        if (pool && pool->has(e.index)) {
+            emit_destroy(component_type_id<T>(), e);
+            notify_views_removed(component_type_id<T>(), e);
             pool->remove(e.index);
         }
     }
 
+    // Remove a component by type ID (for type-erased callers such as CommandQueue)
+    void remove_component(Entity e, ComponentTypeId id);
+
+    // Reserve pool capacity ahead of adding many components of one type
+    template<typename T>
+    void reserve_components(size_t additional) {
+        get_or_create_pool<T>().reserve(additional);
+    }
+
+    // ========== Change Tracking ==========
+
+    // Tick stamped on components by add_component, get_mut, mark_changed and each_mut.
+    // The owner advances it once per simulation tick.
+    void set_change_tick(u32 tick) { change_tick_ = tick; }
+    u32 change_tick() const { return change_tick_; }
+
+    // ========== Component Signals ==========
+
+    // Lifecycle signals for T: construct fires after a component is added, update after
+    // it is replaced or marked changed (get_mut, mark_changed, each_mut), destroy before
+    // it is removed by remove_component or destroy. Costs nothing until subscribed.
+    // Snapshot restores don't fire signals; rebuild indexes after restore_snapshot.
+    template<typename T>
+    ComponentSignal& on_construct() { return signals_for(component_type_id<T>()).construct; }
+
+    template<typename T>
+    ComponentSignal& on_update() { return signals_for(component_type_id<T>()).update; }
+
+    template<typename T>
+    ComponentSignal& on_destroy() { return signals_for(component_type_id<T>()).destroy; }
+
+    // Deliver queued events to deferred subscribers (call at sync points)
+    void dispatch_signals();
+
+    // ========== Snapshots ==========
+
+    // Copy entities, components and network IDs into snapshot, reusing its storage.
+    // Pending commands and systems are not part of a snapshot; flush before saving.
+    void save_snapshot(WorldSnapshot& snapshot) const;
+
+    // Roll back to a snapshot taken from this world. Entity handles and component
+    // pointers obtained after the snapshot must not be used afterwards.
+    void restore_snapshot(const WorldSnapshot& snapshot);
+
+    // ========== Deferred Structural Changes ==========
+
+    // Command buffer for the calling thread. Record creates/destroys/adds/removes here
+    // while iterating or from parallel systems; they apply at the next flush_commands().
+    // Include "core/ecs/command_buffer.hpp" to record.
+    CommandBuffer& commands();
+
+    // Apply all recorded commands (call at sync points, never while iterating)
+    void flush_commands();
+
     // Get the component pool for iteration
     template<typename T>
     ComponentPool<T>* get_pool() {
-        auto it = component_pools_.find(std::type_index(typeid(T)));
-        if (it == component_pools_.end()) return nullptr;
-        return std::any_cast<ComponentPool<T>>(&it->second);
+        ComponentTypeId id = component_type_id<T>();
+        if (id >= component_pools_.size()) return nullptr;
+        return static_cast<ComponentPool<T>*>(component_pools_[id].get());
     }
 
     template<typename T>
     const ComponentPool<T>* get_pool() const {
-        auto it = component_pools_.find(std::type_index(typeid(T)));
-        if (it == component_pools_.end()) return nullptr;
-        return std::any_cast<ComponentPool<T>>(&it->second);
+        ComponentTypeId id = component_type_id<T>();
+        if (id >= component_pools_.size()) return nullptr;
+        return static_cast<const ComponentPool<T>*>(component_pools_[id].get());
+    }
+
+    // Get a pool by type ID without knowing its type (nullptr if no such pool)
+    IComponentPool* get_pool(ComponentTypeId id) {
+        return id < component_pools_.size() ? component_pools_[id].get() : nullptr;
+    }
+
+    const IComponentPool* get_pool(ComponentTypeId id) const {
+        return id < component_pools_.size() ? component_pools_[id].get() : nullptr;
     }
 
+    // Upper bound on pool type IDs (iterate 0..pool_capacity() and skip null pools)
+    size_t pool_capacity() const { return component_pools_.size(); }
+
+    // Bytes reserved by all component pools
+    size_t component_memory_usage() const;
+
+    // Per-pool memory breakdown (one entry per pool this world has created)
+    struct PoolMemoryReport {
+        std::string_view name;      // Registered component type name
+        PoolMemoryStats stats;
+    };
+    std::vector<PoolMemoryReport> component_memory_report() const;
+
     // ========== Network Entity ID Mapping ==========
 
     // Assign a network ID to an entity (server does this)
     void assign_net_id(Entity e, NetEntityId net_id);
 
-    // Get entity by network ID
-    Entity get_by_net_id(NetEntityId net_id) const;
+    // Get entity by network ID (one indexed load; stale generations return null)
+    Entity get_by_net_id(NetEntityId net_id) const {
+        u32 slot = net_id_slot(net_id);
+        if (slot >= net_slots_.size() || net_slots_[slot].net_id != net_id) {
+            return Entity::null();
+        }
+        return net_slots_[slot].entity;
+    }
 
     // Get network ID for entity (returns INVALID_NET_ENTITY_ID if not assigned)
-    NetEntityId get_net_id(Entity e) const;
+    NetEntityId get_net_id(Entity e) const {
+        if (!is_alive(e) || e.index >= entity_net_ids_.size()) return INVALID_NET_ENTITY_ID;
+        return entity_net_ids_[e.index];
+    }
 
-    // Allocate next network ID (server only)
+    // Allocate a network ID (server only). Slots released by destroyed entities are
+    // reused with the next generation.
     NetEntityId allocate_net_id();
 
+    // Allocate and assign a fresh network ID to each entity (server only)
+    void assign_new_net_ids(std::span<const Entity> entities);
+
     // ========== System Management ==========
 
     // Add a system
@@ -122,42 +290,201 @@ public:
         return ref;
     }
 
-    // Update all systems
+    // Update all systems. Systems whose declared access doesn't conflict run
+    // concurrently when a job system is set (see SystemScheduler).
     void update(f32 dt);
 
+    // Job system used by update() (nullptr = run systems sequentially)
+    void set_job_system(JobSystem* jobs) { jobs_ = jobs; }
+
+    // Per-system timings from the last update()
+    const std::vector<SystemTiming>& system_timings() const { return scheduler_.timings(); }
+
     // ========== Iteration Helpers ==========
 
-    // Iterate over all entities with specific components
+    // Iterate over all entities with specific components.
+    // Drives iteration from the smallest participating pool and probes the others,
+    // so rare components keep the query cheap regardless of template argument order.
+    // Structural changes (create/destroy/add/remove) must not happen inside func.
     template<typename First, typename... Rest, typename Func>
     void each(Func&& func) {
-        // Use the first component's pool for iteration
-        auto* first_pool = get_pool<First>();
-        if (!first_pool) return;
-
-        for (auto [entity_index, _] : *first_pool) {
-            Entity e{entity_index, generations_[entity_index]};
-            if (!is_alive(e)) continue;
-
-            // Check all required components (first is guaranteed, check rest)
-            if constexpr (sizeof...(Rest) == 0) {
-                func(e, *get_component<First>(e));
-            } else {
-                if ((has_component<Rest>(e) && ...)) {
-                    func(e, *get_component<First>(e), *get_component<Rest>(e)...);
-                }
+        std::tuple<ComponentPool<First>*, ComponentPool<Rest>*...> pools{
+            get_pool<First>(), get_pool<Rest>()...};
+        if (!std::get<0>(pools) || ((!std::get<ComponentPool<Rest>*>(pools)) || ...)) return;
+
+        dispatch_driver<First, Rest...>(pools, [&]<typename Driver>(ComponentPool<Driver>* driver) {
+            each_driven_by<Driver, First, Rest...>(pools, func, 0, driver->size());
+        });
+    }
+
+    // each() for writers: every visited component is stamped as changed at change_tick().
+    // Use each() plus mark_changed() instead when only some entities actually change.
+    template<typename First, typename... Rest, typename Func>
+    void each_mut(Func&& func) {
+        each<First, Rest...>([&](Entity e, First& first, Rest&... rest) {
+            func(e, first, rest...);
+            get_pool<First>()->mark_changed(e.index, change_tick_);
+            (get_pool<Rest>()->mark_changed(e.index, change_tick_), ...);
+            emit_update(component_type_id<First>(), e);
+            (emit_update(component_type_id<Rest>(), e), ...);
+        });
+    }
+
+    // Call func(entity, T&) for every T stamped at or after since_tick.
+    // Scans the pool's whole dense array, comparing stamps; unchanged entries cost a
+    // compare and no sparse lookups.
+    template<typename T, typename Func>
+    void each_changed_since(u32 since_tick, Func&& func) {
+        auto* pool = get_pool<T>();
+        if (!pool) return;
+        for (size_t i = 0; i < pool->size(); ++i) {
+            if (pool->changed_tick_at(i) < since_tick) continue;
+            u32 entity_index = pool->entity_at(i);
+            func(Entity{entity_index, generations_[entity_index]}, pool->component_at(i));
+        }
+    }
+
+    // Parallel version of each(): splits the smallest pool's dense range across the job
+    // system. func runs concurrently and may only touch the components it is handed
+    // (plus thread-safe or read-only shared state). Blocks until every entity is visited.
+    template<typename First, typename... Rest, typename Func>
+    void par_each(JobSystem& jobs, Func&& func, size_t grain = 64) {
+        std::tuple<ComponentPool<First>*, ComponentPool<Rest>*...> pools{
+            get_pool<First>(), get_pool<Rest>()...};
+        if (!std::get<0>(pools) || ((!std::get<ComponentPool<Rest>*>(pools)) || ...)) return;
+
+        dispatch_driver<First, Rest...>(pools, [&]<typename Driver>(ComponentPool<Driver>* driver) {
+            jobs.parallel_for(driver->size(), grain, [&](size_t begin, size_t end) {
+                each_driven_by<Driver, First, Rest...>(pools, func, begin, end);
+            });
+        });
+    }
+
+    // Persistent cached query over entities that have all of Ts.
+    // The view's match list is updated incrementally on add/remove/destroy, so hot
+    // queries iterate O(matches) instead of O(pool size). Created on first request.
+    template<typename... Ts>
+    View<Ts...>& view() {
+        const std::vector<ComponentTypeId> signature{component_type_id<Ts>()...};
+        for (auto& existing : views_) {
+            if (existing->signature() == signature) {
+                return static_cast<View<Ts...>&>(*existing);
             }
         }
+
+        auto created = std::make_unique<View<Ts...>>(get_or_create_pool<Ts>()...);
+        View<Ts...>& ref = *created;
+        each<Ts...>([&ref](Entity e, Ts&...) { ref.on_component_added(e); });
+
+        for (ComponentTypeId id : signature) {
+            if (id >= views_by_type_.size()) {
+                views_by_type_.resize(static_cast<size_t>(id) + 1);
+            }
+            views_by_type_[id].push_back(&ref);
+        }
+        views_.push_back(std::move(created));
+        return ref;
     }
 
 private:
+    friend class WorldSnapshot;
+
+    // Call visit(pool) with the smallest of the given pools
+    template<typename... Ts, typename Pools, typename Visit>
+    static void dispatch_driver(Pools& pools, Visit&& visit) {
+        if constexpr (sizeof...(Ts) == 1) {
+            visit(std::get<0>(pools));
+        } else {
+            const size_t sizes[] = {std::get<ComponentPool<Ts>*>(pools)->size()...};
+            size_t driver = 0;
+            for (size_t i = 1; i < std::size(sizes); ++i) {
+                if (sizes[i] < sizes[driver]) driver = i;
+            }
+
+            [&]<size_t... I>(std::index_sequence<I...>) {
+                ((I == driver ? visit(std::get<I>(pools)) : void()), ...);
+            }(std::index_sequence_for<Ts...>{});
+        }
+    }
+
+    // Visit dense positions [begin, end) of the driver pool, probing the other pools
+    template<typename Driver, typename... Ts, typename Pools, typename Func>
+    void each_driven_by(Pools& pools, Func& func, size_t begin, size_t end) {
+        auto* driver = std::get<ComponentPool<Driver>*>(pools);
+        for (size_t i = begin; i < end; ++i) {
+            u32 entity_index = driver->entity_at(i);
+            std::tuple<Ts*...> components{fetch_for_each<Ts, Driver>(
+                pools, entity_index, driver->component_at(i))...};
+            if (((std::get<Ts*>(components) == nullptr) || ...)) continue;
+
+            func(Entity{entity_index, generations_[entity_index]}, *std::get<Ts*>(components)...);
+        }
+    }
+
+    template<typename T, typename Driver, typename Pools>
+    static T* fetch_for_each(Pools& pools, u32 entity_index, Driver& driver_component) {
+        if constexpr (std::is_same_v<T, Driver>) {
+            return &driver_component;
+        } else {
+            return std::get<ComponentPool<T>*>(pools)->get(entity_index);
+        }
+    }
+
+    // Set the component and notify views/signals (shared by the add_component variants)
+    template<typename T>
+    T& add_to_pool(ComponentPool<T>& pool, Entity e, T component) {
+        bool added = !pool.has(e.index);
+        T& ref = pool.set(e.index, std::move(component), change_tick_);
+        if (added) {
+            notify_views_added(component_type_id<T>(), e);
+            emit_construct(component_type_id<T>(), e);
+        } else {
+            emit_update(component_type_id<T>(), e);
+        }
+        return ref;
+    }
+
+    ComponentSignals& signals_for(ComponentTypeId id);
+
+    ComponentSignals* find_signals(ComponentTypeId id) {
+        return id < signals_.size() ? signals_[id].get() : nullptr;
+    }
+
+    void emit_construct(ComponentTypeId id, Entity e) {
+        if (auto* signals = find_signals(id)) signals->construct.emit(*this, e);
+    }
+
+    void emit_update(ComponentTypeId id, Entity e) {
+        if (auto* signals = find_signals(id)) signals->update.emit(*this, e);
+    }
+
+    void emit_destroy(ComponentTypeId id, Entity e) {
+        if (auto* signals = find_signals(id)) signals->destroy.emit(*this, e);
+    }
+
+    void notify_views_added(ComponentTypeId id, Entity e) {
+        if (id < views_by_type_.size()) {
+            for (IView* v : views_by_type_[id]) v->on_component_added(e);
+        }
+    }
+
+    void notify_views_removed(ComponentTypeId id, Entity e) {
+        if (id < views_by_type_.size()) {
+            for (IView* v : views_by_type_[id]) v->on_component_removed(e);
+        }
+    }
+
     template<typename T>
     ComponentPool<T>& get_or_create_pool() {
-        auto type = std::type_index(typeid(T));
-        auto it = component_pools_.find(type);
-        if (it == component_pools_.end()) {
-            it = component_pools_.emplace(type, ComponentPool<T>{}).first;
+        ComponentTypeId id = component_type_id<T>();
+        if (id >= component_pools_.size()) {
+            component_pools_.resize(static_cast<size_t>(id) + 1);
+        }
+        auto& pool = component_pools_[id];
+        if (!pool) {
+            pool = std::make_unique<ComponentPool<T>>();
         }
-        return std::any_cast<ComponentPool<T>&>(it->second);
+        return static_cast<ComponentPool<T>&>(*pool);
     }
 
     // Entity storage
@@ -165,16 +492,67 @@ private:
     std::vector<u32> free_indices_;         // Recycled entity indices
     size_t alive_count_ = 0;
 
-    // Component storage
-    std::unordered_map<std::type_index, std::any> component_pools_;
+    // Component storage, indexed by ComponentTypeId (null for types this world never used)
+    std::vector<std::unique_ptr<IComponentPool>> component_pools_;
+
+    // Persistent views and, per component type, the views that depend on it
+    std::vector<std::unique_ptr<IView>> views_;
+    std::vector<std::vector<IView*>> views_by_type_;
+
+    // Lifecycle signals, indexed by ComponentTypeId (null until first subscribed)
+    std::vector<std::unique_ptr<ComponentSignals>> signals_;
+
+    // Network ID mapping. A slot keeps its last net_id after release so the next
+    // allocation can bump the generation; entity is null while the slot is free.
+    // Only slots allocate_net_id handed out are recycled (IDs from assign_net_id belong to
+    // whoever issued them), and each is on free_net_slots_ at most once.
+    struct NetSlot {
+        Entity entity{Entity::null()};
+        NetEntityId net_id{INVALID_NET_ENTITY_ID};
+        bool allocated{false};      // Handed out by allocate_net_id
+        bool free_listed{false};    // On free_net_slots_
+    };
+
+    // Drop the entity's network ID mapping and recycle its slot if it was allocated here
+    void release_net_id(u32 entity_index);
+
+    std::vector<NetSlot> net_slots_{1};             // net_id slot -> entity (slot 0 reserved)
+    std::vector<NetEntityId> entity_net_ids_;       // entity.index -> net_id
+    std::vector<u32> free_net_slots_;               // Released slots
+
+    // Current tick for change stamps
+    u32 change_tick_ = 0;
 
-    // Network ID mapping
-    std::unordered_map<NetEntityId, Entity> net_to_entity_;
-    std::unordered_map<u32, NetEntityId> entity_to_net_;  // entity.index -> net_id
-    NetEntityId next_net_id_ = 1;
+    // Deferred structural changes
+    std::unique_ptr<CommandQueue> commands_;
 
     // Systems
     std::vector<std::unique_ptr<System>> systems_;
+    SystemScheduler scheduler_;
+    JobSystem* jobs_{nullptr};
+};
+
+// Saved copy of a World's entities, components and network IDs (see World::save_snapshot).
+// Keep one around and save into it repeatedly: pools and arrays keep their capacity, so
+// a save is a series of vector copies (memcpy for trivially copyable components).
+class WorldSnapshot {
+public:
+    bool empty() const { return !saved_; }
+
+    // Bytes held by the snapshot's component pools
+    size_t memory_usage() const;
+
+private:
+    friend class World;
+
+    bool saved_{false};
+    std::vector<u32> generations_;
+    std::vector<u32> free_indices_;
+    size_t alive_count_ = 0;
+    std::vector<std::unique_ptr<IComponentPool>> pools_;    // Indexed by ComponentTypeId
+    std::vector<World::NetSlot> net_slots_;
+    std::vector<NetEntityId> entity_net_ids_;
+    std::vector<u32> free_net_slots_;
 };
 
 } // namespace city
@@ -116,5 +116,15 @@ void update_movement(Transform& transform, Player& player, const TileMap& tilema
     }
 }
 
+void steer_by_flow_field(Player& player, const Transform& transform, const FlowField& field) {
+    TilePos tile{player.move_target.x, player.move_target.y};
+    if (player.movement_mode == MovementMode::Free || !player.is_moving) {
+        tile = TilePos{static_cast<i32>(std::floor(transform.position.x)),
+                       static_cast<i32>(std::floor(transform.position.y))};
+    }
+    TilePos step = field.direction_at(tile);
+    apply_input(player, Vec2i{step.x, step.y});
+}
+
 } // namespace MoverSystem
 } // namespace city
@@ -2,6 +2,7 @@
 
 #include "core/game/components/transform.hpp"
 #include "core/game/components/player.hpp"
+#include "core/grid/flow_field.hpp"
 #include "core/grid/tilemap.hpp"
 
 namespace city {
@@ -19,6 +20,13 @@ void update_movement(Transform& transform, Player& player, const TileMap& tilema
 // Call this when new input is received (client: every frame, server: when packet arrives)
 void apply_input(Player& player, Vec2i direction);
 
+// Steer a mover along a flow field by feeding the field's step as its input direction.
+// Grid-locked movers look up the tile they are moving into (so the next step queues
+// without a pause), otherwise the tile under them. The input goes to zero at the goal or
+// where it can't be reached. O(1) and read-only on the field, so it can run inside the
+// parallel movement pass as long as the field isn't being updated.
+void steer_by_flow_field(Player& player, const Transform& transform, const FlowField& field);
+
 } // namespace MoverSystem
 
 } // namespace city
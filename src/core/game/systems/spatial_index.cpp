@@ -0,0 +1,247 @@
+#include "spatial_index.hpp"
+#include "core/game/components/transform.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+namespace city {
+
+SpatialIndex::~SpatialIndex() {
+    detach();
+}
+
+void SpatialIndex::attach(World& world) {
+    detach();
+    world_ = &world;
+    auto handler = [this](World&, std::span<const Entity> entities) {
+        for (Entity e : entities) sync(e);
+    };
+    construct_id_ = world.on_construct<Transform>().connect_deferred(handler);
+    update_id_ = world.on_update<Transform>().connect_deferred(handler);
+    destroy_id_ = world.on_destroy<Transform>().connect_deferred(handler);
+    rebuild();
+}
+
+void SpatialIndex::detach() {
+    if (!world_) return;
+    world_->on_construct<Transform>().disconnect(construct_id_);
+    world_->on_update<Transform>().disconnect(update_id_);
+    world_->on_destroy<Transform>().disconnect(destroy_id_);
+    world_ = nullptr;
+}
+
+void SpatialIndex::rebuild() {
+    clear();
+    if (!world_) return;
+    world_->each<Transform>([this](Entity e, Transform& transform) {
+        insert(e, transform.position);
+    });
+}
+
+void SpatialIndex::sync(Entity e) {
+    // Events arrive batched, so look at the current state rather than the event kind: the
+    // component may have been added and removed again, or the entity recycled, since
+    const Transform* transform = world_->get_component<Transform>(e);
+    if (transform) {
+        move(e, transform->position);
+    } else {
+        remove(e);
+    }
+}
+
+void SpatialIndex::insert(Entity e, Vec2f position) {
+    if (e.index >= slots_.size()) slots_.resize(static_cast<size_t>(e.index) + 1);
+    if (slots_[e.index].entity.is_valid()) unlink(slots_[e.index]);
+
+    u32 cell = cell_for(cell_coord(position.x), cell_coord(position.y));
+    auto& items = cells_[cell].items;
+    slots_[e.index] = {e, cell, static_cast<u32>(items.size())};
+    items.push_back({e, position});
+    ++size_;
+}
+
+void SpatialIndex::move(Entity e, Vec2f position) {
+    if (!contains(e)) {
+        insert(e, position);
+        return;
+    }
+
+    Slot& slot = slots_[e.index];
+    Cell& cell = cells_[slot.cell];
+    if (cell.x == cell_coord(position.x) && cell.y == cell_coord(position.y)) {
+        cell.items[slot.item].position = position;
+    } else {
+        insert(e, position);
+    }
+}
+
+void SpatialIndex::remove(Entity e) {
+    if (contains(e)) unlink(slots_[e.index]);
+}
+
+void SpatialIndex::clear() {
+    cells_.clear();
+    cell_lookup_.clear();
+    slots_.clear();
+    size_ = 0;
+    bounds_ = {};
+}
+
+bool SpatialIndex::contains(Entity e) const {
+    return e.index < slots_.size() && slots_[e.index].entity == e;
+}
+
+u32 SpatialIndex::cell_for(i32 x, i32 y) {
+    auto [it, inserted] = cell_lookup_.try_emplace(cell_key(x, y), static_cast<u32>(cells_.size()));
+    if (inserted) {
+        if (cells_.empty()) {
+            bounds_ = {x, y, 1, 1};
+        } else {
+            i32 x0 = std::min(bounds_.x, x);
+            i32 y0 = std::min(bounds_.y, y);
+            i32 x1 = std::max(bounds_.x + bounds_.width - 1, x);
+            i32 y1 = std::max(bounds_.y + bounds_.height - 1, y);
+            bounds_ = {x0, y0, x1 - x0 + 1, y1 - y0 + 1};
+        }
+        cells_.push_back({x, y, {}});
+    }
+    return it->second;
+}
+
+void SpatialIndex::unlink(Slot& slot) {
+    auto& items = cells_[slot.cell].items;
+    if (slot.item + 1 != items.size()) {
+        items[slot.item] = items.back();
+        slots_[items[slot.item].entity.index].item = slot.item;
+    }
+    items.pop_back();
+    slot.entity = Entity::null();
+    --size_;
+}
+
+template<typename Func>
+void SpatialIndex::for_cells(i32 x0, i32 y0, i32 x1, i32 y1, Func&& func) const {
+    if (cells_.empty()) return;
+    x0 = std::max(x0, bounds_.x);
+    y0 = std::max(y0, bounds_.y);
+    x1 = std::min(x1, bounds_.x + bounds_.width - 1);
+    y1 = std::min(y1, bounds_.y + bounds_.height - 1);
+    if (x0 > x1 || y0 > y1) return;
+
+    i64 area = (i64{x1} - x0 + 1) * (i64{y1} - y0 + 1);
+    if (area > static_cast<i64>(cells_.size())) {
+        for (const Cell& cell : cells_) {
+            if (cell.x >= x0 && cell.x <= x1 && cell.y >= y0 && cell.y <= y1) func(cell);
+        }
+        return;
+    }
+    for (i32 y = y0; y <= y1; ++y) {
+        for (i32 x = x0; x <= x1; ++x) {
+            if (const Cell* cell = find_cell(x, y)) func(*cell);
+        }
+    }
+}
+
+size_t SpatialIndex::query_radius(Vec2f center, f32 radius, std::vector<Entity>& out) const {
+    out.clear();
+    if (!(radius >= 0.0f)) return 0;
+
+    f32 radius_sq = radius * radius;
+    for_cells(cell_coord(center.x - radius), cell_coord(center.y - radius),
+              cell_coord(center.x + radius), cell_coord(center.y + radius),
+              [&](const Cell& cell) {
+        for (const Item& item : cell.items) {
+            Vec2f d = item.position - center;
+            if (d.x * d.x + d.y * d.y <= radius_sq) out.push_back(item.entity);
+        }
+    });
+    return out.size();
+}
+
+size_t SpatialIndex::query_rect(Rectf rect, std::vector<Entity>& out) const {
+    out.clear();
+    if (!(rect.width > 0.0f && rect.height > 0.0f)) return 0;
+
+    for_cells(cell_coord(rect.left()), cell_coord(rect.top()),
+              cell_coord(rect.right()), cell_coord(rect.bottom()),
+              [&](const Cell& cell) {
+        for (const Item& item : cell.items) {
+            if (rect.contains(item.position)) out.push_back(item.entity);
+        }
+    });
+    return out.size();
+}
+
+size_t SpatialIndex::query_nearest(Vec2f center, size_t k, std::vector<Neighbor>& out,
+                                   f32 max_radius) const {
+    out.clear();
+    if (k == 0 || size_ == 0 || !(max_radius >= 0.0f)) return 0;
+
+    // out is a max-heap on distance while collecting, so the worst candidate is at front
+    auto nearer = [](const Neighbor& a, const Neighbor& b) {
+        return a.distance_sq < b.distance_sq;
+    };
+    f32 limit_sq = max_radius * max_radius;
+    auto consider = [&](const Cell& cell) {
+        for (const Item& item : cell.items) {
+            Vec2f d = item.position - center;
+            f32 distance_sq = d.x * d.x + d.y * d.y;
+            if (distance_sq > limit_sq) continue;
+            if (out.size() < k) {
+                out.push_back({item.entity, distance_sq});
+                std::push_heap(out.begin(), out.end(), nearer);
+            } else if (distance_sq < out.front().distance_sq) {
+                std::pop_heap(out.begin(), out.end(), nearer);
+                out.back() = {item.entity, distance_sq};
+                std::push_heap(out.begin(), out.end(), nearer);
+            }
+        }
+    };
+
+    // Visit rings of cells around the centre's cell until nothing unvisited can be nearer
+    i32 cx = cell_coord(center.x);
+    i32 cy = cell_coord(center.y);
+    i64 last_ring = std::max({std::abs(i64{cx} - bounds_.x),
+                              std::abs(i64{cx} - (bounds_.x + bounds_.width - 1)),
+                              std::abs(i64{cy} - bounds_.y),
+                              std::abs(i64{cy} - (bounds_.y + bounds_.height - 1))});
+    constexpr auto cell_size = static_cast<f32>(CELL_SIZE);
+    for (i32 ring = 0; ring <= last_ring; ++ring) {
+        if (ring > 0) {
+            // Distance from the centre to the edge of the square of cells visited so far
+            f32 reach = std::min({center.x - static_cast<f32>(cx - ring + 1) * cell_size,
+                                  static_cast<f32>(cx + ring) * cell_size - center.x,
+                                  center.y - static_cast<f32>(cy - ring + 1) * cell_size,
+                                  static_cast<f32>(cy + ring) * cell_size - center.y});
+            if (reach > max_radius) break;
+            if (out.size() == k && reach * reach >= out.front().distance_sq) break;
+        }
+
+        // Sparse cells far apart: scan whatever is left in one pass
+        if (static_cast<size_t>(ring) * 8 > cells_.size()) {
+            for (const Cell& cell : cells_) {
+                if (std::max(std::abs(cell.x - cx), std::abs(cell.y - cy)) >= ring) {
+                    consider(cell);
+                }
+            }
+            break;
+        }
+
+        if (ring == 0) {
+            if (const Cell* cell = find_cell(cx, cy)) consider(*cell);
+            continue;
+        }
+        for (i32 x = cx - ring; x <= cx + ring; ++x) {
+            if (const Cell* cell = find_cell(x, cy - ring)) consider(*cell);
+            if (const Cell* cell = find_cell(x, cy + ring)) consider(*cell);
+        }
+        for (i32 y = cy - ring + 1; y < cy + ring; ++y) {
+            if (const Cell* cell = find_cell(cx - ring, y)) consider(*cell);
+            if (const Cell* cell = find_cell(cx + ring, y)) consider(*cell);
+        }
+    }
+
+    std::sort_heap(out.begin(), out.end(), nearer);
+    return out.size();
+}
+
+} // namespace city
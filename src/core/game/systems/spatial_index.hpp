@@ -0,0 +1,124 @@
+#pragma once
+
+#include "core/ecs/world.hpp"
+#include "core/grid/chunk.hpp"
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace city {
+
+// Entities bucketed by the CHUNK_SIZE cell under their Transform position, for "what is
+// near here" queries (chat and interaction range, collision, interest management, render
+// culling) without scanning every Transform.
+//
+// Cells live in a hash map keyed by cell coordinates, each holding its entities and their
+// positions, so queries touch only the cells they overlap and never the World. Moves
+// within a cell just update the stored position; crossing into another cell is an O(1)
+// swap-remove and append.
+//
+// attach() indexes a World's Transforms and keeps up through its deferred component
+// signals, so the index reflects the world as of the last World::dispatch_signals()
+// (Transform writes must be stamped via get_mut, mark_changed or each_mut). Call
+// rebuild() after World::restore_snapshot, which fires no signals. insert/move/remove can
+// also be driven by hand. Queries are const and may run on several threads at once, but
+// not while the index is being updated.
+class SpatialIndex {
+public:
+    static constexpr i32 CELL_SIZE = CHUNK_SIZE;
+
+    struct Neighbor {
+        Entity entity;
+        f32 distance_sq;
+    };
+
+    SpatialIndex() = default;
+    ~SpatialIndex();
+
+    SpatialIndex(const SpatialIndex&) = delete;
+    SpatialIndex& operator=(const SpatialIndex&) = delete;
+
+    // Index every entity with a Transform and follow changes through signals
+    void attach(World& world);
+    void detach();
+
+    // Re-read every Transform of the attached world
+    void rebuild();
+
+    void insert(Entity e, Vec2f position);     // Replaces any entry for e
+    void move(Entity e, Vec2f position);       // Inserts if e isn't indexed
+    void remove(Entity e);
+    void clear();
+
+    bool contains(Entity e) const;
+    size_t size() const { return size_; }
+    size_t cell_count() const { return cells_.size(); }
+
+    // Queries clear `out` and fill it; they return the number of entities found.
+    // Entities within `radius` of center (inclusive), in no particular order
+    size_t query_radius(Vec2f center, f32 radius, std::vector<Entity>& out) const;
+
+    // Entities inside rect (min edges inclusive, max edges exclusive), in no particular order
+    size_t query_rect(Rectf rect, std::vector<Entity>& out) const;
+
+    // Up to k entities closest to center within max_radius, nearest first
+    size_t query_nearest(Vec2f center, size_t k, std::vector<Neighbor>& out,
+                         f32 max_radius = std::numeric_limits<f32>::infinity()) const;
+
+private:
+    struct Item {
+        Entity entity;
+        Vec2f position;
+    };
+
+    struct Cell {
+        i32 x;
+        i32 y;
+        std::vector<Item> items;
+    };
+
+    // Where an entity is stored, indexed by Entity::index
+    struct Slot {
+        Entity entity{Entity::null()};
+        u32 cell{0};
+        u32 item{0};
+    };
+
+    static i32 cell_coord(f32 v) {
+        return static_cast<i32>(std::floor(v)) >> CHUNK_SHIFT;
+    }
+
+    static u64 cell_key(i32 x, i32 y) {
+        return (static_cast<u64>(static_cast<u32>(x)) << 32) | static_cast<u32>(y);
+    }
+
+    const Cell* find_cell(i32 x, i32 y) const {
+        auto it = cell_lookup_.find(cell_key(x, y));
+        return it == cell_lookup_.end() ? nullptr : &cells_[it->second];
+    }
+
+    u32 cell_for(i32 x, i32 y);
+    void unlink(Slot& slot);
+
+    // Bring e in line with the attached world (signal handler)
+    void sync(Entity e);
+
+    // Call func(cell) for every cell overlapping the cell rect [x0, x1] x [y0, y1],
+    // scanning all cells instead when that is cheaper
+    template<typename Func>
+    void for_cells(i32 x0, i32 y0, i32 x1, i32 y1, Func&& func) const;
+
+    World* world_{nullptr};
+    ComponentSignal::ConnectionId construct_id_{0};
+    ComponentSignal::ConnectionId update_id_{0};
+    ComponentSignal::ConnectionId destroy_id_{0};
+
+    std::vector<Cell> cells_;       // Never shrinks; empty cells are kept for reuse
+    std::unordered_map<u64, u32> cell_lookup_;
+    std::vector<Slot> slots_;
+    size_t size_{0};
+    Recti bounds_;                  // Cell coordinates covering every cell ever created
+};
+
+} // namespace city
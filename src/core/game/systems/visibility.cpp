@@ -0,0 +1,99 @@
+#include "visibility.hpp"
+#include <algorithm>
+#include <atomic>
+
+namespace city {
+
+VisibilitySystem::VisibilitySystem(const TileMap& map, i32 radius)
+    : map_(map), radius_(radius) {}
+
+void VisibilitySystem::update(std::span<const TilePos> viewers, std::span<const TilePos> targets,
+                              JobSystem& jobs) {
+    viewer_count_ = viewers.size();
+    target_count_ = targets.size();
+    words_per_viewer_ = (targets.size() + 63) / 64;
+    if (views_.size() < viewers.size()) views_.resize(viewers.size());
+    bits_.assign(viewers.size() * words_per_viewer_, 0);
+
+    bool binned = bin_targets(targets);
+    std::atomic<u32> recomputed{0};
+    jobs.parallel_for(viewers.size(), 4, [&](size_t begin, size_t end) {
+        u32 count = 0;
+        for (size_t i = begin; i < end; ++i) {
+            View& view = views_[i];
+            if (!view.valid || view.fov.origin() != viewers[i] ||
+                view.fov.radius() != radius_ || !view.fov.is_current(map_)) {
+                view.fov.compute(map_, viewers[i], radius_);
+                view.valid = true;
+                ++count;
+            }
+
+            u64* row = bits_.data() + i * words_per_viewer_;
+            if (!binned) {
+                for (size_t t = 0; t < targets.size(); ++t) {
+                    if (view.fov.is_visible(targets[t])) row[t >> 6] |= u64{1} << (t & 63);
+                }
+                continue;
+            }
+
+            // Cells overlapping the viewer's square, relative to the binned box
+            TilePos origin = viewers[i];
+            i32 first_x = std::max(((origin.x - radius_) >> CHUNK_SHIFT) - cells_.x, 0);
+            i32 first_y = std::max(((origin.y - radius_) >> CHUNK_SHIFT) - cells_.y, 0);
+            i32 last_x = std::min(((origin.x + radius_) >> CHUNK_SHIFT) - cells_.x,
+                                  cells_.width - 1);
+            i32 last_y = std::min(((origin.y + radius_) >> CHUNK_SHIFT) - cells_.y,
+                                  cells_.height - 1);
+            for (i32 cy = first_y; cy <= last_y; ++cy) {
+                for (i32 cx = first_x; cx <= last_x; ++cx) {
+                    auto cell = static_cast<size_t>(cy * cells_.width + cx);
+                    for (u32 k = cell_start_[cell]; k < cell_start_[cell + 1]; ++k) {
+                        u32 t = cell_targets_[k];
+                        if (view.fov.is_visible(targets[t])) row[t >> 6] |= u64{1} << (t & 63);
+                    }
+                }
+            }
+        }
+        recomputed.fetch_add(count, std::memory_order_relaxed);
+    });
+    last_recomputed_ = recomputed.load(std::memory_order_relaxed);
+}
+
+bool VisibilitySystem::bin_targets(std::span<const TilePos> targets) {
+    if (targets.empty()) return false;
+
+    i32 min_x = targets[0].x >> CHUNK_SHIFT;
+    i32 min_y = targets[0].y >> CHUNK_SHIFT;
+    i32 max_x = min_x;
+    i32 max_y = min_y;
+    for (TilePos target : targets) {
+        min_x = std::min(min_x, target.x >> CHUNK_SHIFT);
+        min_y = std::min(min_y, target.y >> CHUNK_SHIFT);
+        max_x = std::max(max_x, target.x >> CHUNK_SHIFT);
+        max_y = std::max(max_y, target.y >> CHUNK_SHIFT);
+    }
+    i64 cell_count = (i64{max_x} - min_x + 1) * (i64{max_y} - min_y + 1);
+    if (cell_count > static_cast<i64>(targets.size()) * 4 + 64) return false;
+
+    cells_ = {min_x, min_y, max_x - min_x + 1, max_y - min_y + 1};
+    auto cell_of = [this](TilePos target) {
+        return static_cast<size_t>((target.y >> CHUNK_SHIFT) - cells_.y) *
+                   static_cast<size_t>(cells_.width) +
+               static_cast<size_t>((target.x >> CHUNK_SHIFT) - cells_.x);
+    };
+
+    cell_start_.assign(static_cast<size_t>(cell_count) + 1, 0);
+    for (TilePos target : targets) ++cell_start_[cell_of(target) + 1];
+    for (size_t i = 1; i < cell_start_.size(); ++i) cell_start_[i] += cell_start_[i - 1];
+
+    // Fill using the starts as cursors, then shift them back
+    cell_targets_.resize(targets.size());
+    for (size_t t = 0; t < targets.size(); ++t) {
+        cell_targets_[cell_start_[cell_of(targets[t])]++] = static_cast<u32>(t);
+    }
+    for (size_t i = cell_start_.size() - 1; i > 0; --i) cell_start_[i] = cell_start_[i - 1];
+    cell_start_[0] = 0;
+    return true;
+}
+
+} // namespace city
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "core/grid/field_of_view.hpp"
+#include "core/util/job_system.hpp"
+#include <span>
+#include <vector>
+
+namespace city {
+
+// Interaction ranges in tiles (see docs/game-design.md)
+constexpr i32 LOCAL_CHAT_RANGE = 5;
+constexpr i32 SHOUT_RANGE = 15;
+
+// Which viewers can see which targets this tick, for interest management and chat routing.
+//
+// Each tick the caller lists the viewer tiles (players) and target tiles (entities);
+// update() gives every viewer a FieldOfView of the configured radius and fills one bitset
+// row per viewer, bit t set when target t is visible. A viewer's field is only recomputed
+// when its tile changed or a chunk under it did (FieldOfView::is_current), so players
+// standing still cost just the bitset fill. Targets are binned by chunk first so each
+// viewer only tests the targets near it. Viewers are spread across the job system.
+//
+// Fields are kept per viewer index: keep the viewer order stable between ticks so they can
+// be reused. Putting the viewers first among the targets makes viewer i target i, which is
+// handy for player-to-player checks.
+class VisibilitySystem {
+public:
+    VisibilitySystem(const TileMap& map, i32 radius);
+
+    void update(std::span<const TilePos> viewers, std::span<const TilePos> targets,
+                JobSystem& jobs);
+
+    i32 radius() const { return radius_; }
+    size_t viewer_count() const { return viewer_count_; }
+    size_t target_count() const { return target_count_; }
+
+    // Visibility row of a viewer: (target_count + 63) / 64 words, bit t = target t
+    std::span<const u64> visible_targets(size_t viewer) const {
+        return {bits_.data() + viewer * words_per_viewer_, words_per_viewer_};
+    }
+
+    bool sees(size_t viewer, size_t target) const {
+        return (bits_[viewer * words_per_viewer_ + (target >> 6)] >> (target & 63)) & 1;
+    }
+
+    const FieldOfView& field_of_view(size_t viewer) const { return views_[viewer].fov; }
+
+    // Viewers whose field had to be recomputed by the last update() (for profiling)
+    u32 last_recomputed() const { return last_recomputed_; }
+
+private:
+    struct View {
+        FieldOfView fov;
+        bool valid{false};
+    };
+
+    // Counting-sort targets into chunk cells over their bounding box; false if the box is
+    // too sparse to be worth it (viewers then test every target)
+    bool bin_targets(std::span<const TilePos> targets);
+
+    const TileMap& map_;
+    i32 radius_;
+    std::vector<View> views_;       // Indexed by viewer
+    std::vector<u64> bits_;         // viewer_count_ rows of words_per_viewer_ words
+    Recti cells_;                   // Target bounding box in chunk coordinates
+    std::vector<u32> cell_start_;   // Per cell, offset into cell_targets_ (+1 sentinel)
+    std::vector<u32> cell_targets_; // Target indices grouped by cell
+    size_t viewer_count_{0};
+    size_t target_count_{0};
+    size_t words_per_viewer_{0};
+    u32 last_recomputed_{0};
+};
+
+} // namespace city
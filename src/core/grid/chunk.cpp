@@ -1,11 +1,29 @@
 #include "chunk.hpp"
+#include <algorithm>
+#include <bit>
 
 namespace city {
 
-Tile* Chunk::at_world(TilePos world_pos) {
-    if (!contains(world_pos)) return nullptr;
-    TilePos local = world_to_local(world_pos);
-    return &at(local.x, local.y);
+bool Chunk::set(i32 local_x, i32 local_y, Tile tile) {
+    Tile& slot = tiles_[static_cast<size_t>(local_y * CHUNK_SIZE + local_x)];
+    if (slot != tile) {
+        slot = tile;
+        ++version_;
+    }
+
+    auto bit = static_cast<ChunkRowMask>(1u << local_x);
+    bool changed = false;
+    for (size_t i = 0; i < TILE_PLANE_COUNT; ++i) {
+        auto& row = planes_[i][static_cast<size_t>(local_y)];
+        ChunkRowMask old_row = row;
+        if (has_flag(tile.flags, plane_flag(static_cast<TilePlane>(i)))) {
+            row = static_cast<ChunkRowMask>(row | bit);
+        } else {
+            row = static_cast<ChunkRowMask>(row & ~bit);
+        }
+        changed |= row != old_row;
+    }
+    return changed;
 }
 
 const Tile* Chunk::at_world(TilePos world_pos) const {
@@ -42,23 +60,194 @@ TilePos Chunk::get_chunk_origin(TilePos world_pos) {
     };
 }
 
+namespace {
+
+constexpr size_t TILE_COUNT = CHUNK_SIZE * CHUNK_SIZE;
+
+// How Chunk::serialize stores the tiles after the origin
+enum class ChunkEncoding : u8 {
+    Uniform = 0,    // One tile everywhere: just that tile
+    Packed = 1,     // Palette, then every tile's palette index bit-packed
+    Runs = 2,       // Palette, run count, then bit-packed (index, length - 1) runs
+};
+
+// LSB-first bit packing straight into a Serializer
+class BitWriter {
+public:
+    explicit BitWriter(Serializer& s) : s_(s) {}
+
+    void write(u32 value, u32 bits) {
+        bits_ |= u64{value} << count_;
+        count_ += bits;
+        while (count_ >= 8) {
+            s_.write_u8(static_cast<u8>(bits_));
+            bits_ >>= 8;
+            count_ -= 8;
+        }
+    }
+
+    void flush() {
+        if (count_ > 0) s_.write_u8(static_cast<u8>(bits_));
+        bits_ = 0;
+        count_ = 0;
+    }
+
+private:
+    Serializer& s_;
+    u64 bits_{0};
+    u32 count_{0};
+};
+
+class BitReader {
+public:
+    explicit BitReader(Deserializer& d) : d_(d) {}
+
+    u32 read(u32 bits) {
+        while (count_ < bits) {
+            bits_ |= u64{d_.read_u8()} << count_;
+            count_ += 8;
+        }
+        auto value = static_cast<u32>(bits_ & ((u64{1} << bits) - 1));
+        bits_ >>= bits;
+        count_ -= bits;
+        return value;
+    }
+
+private:
+    Deserializer& d_;
+    u64 bits_{0};
+    u32 count_{0};
+};
+
+} // namespace
+
 void Chunk::serialize(Serializer& s) const {
     origin_.serialize(s);
-    for (const auto& tile : tiles_) {
-        tile.serialize(s);
+
+    // Distinct tiles in first-seen order, each tile's index into them, and the number of
+    // runs of equal tiles in row-major order
+    std::array<Tile, TILE_COUNT> palette;
+    std::array<u8, TILE_COUNT> indices;
+    u32 palette_size = 0;
+    u32 runs = 0;
+    for (size_t i = 0; i < TILE_COUNT; ++i) {
+        if (i > 0 && tiles_[i] == tiles_[i - 1]) {
+            indices[i] = indices[i - 1];
+            continue;
+        }
+        ++runs;
+        u32 p = 0;
+        while (p < palette_size && palette[p] != tiles_[i]) ++p;
+        if (p == palette_size) palette[palette_size++] = tiles_[i];
+        indices[i] = static_cast<u8>(p);
+    }
+
+    if (palette_size == 1) {
+        s.write_u8(static_cast<u8>(ChunkEncoding::Uniform));
+        tiles_[0].serialize(s);
+        return;
+    }
+
+    // Runs are never longer than 255 tiles here, so a length fits in 8 bits
+    auto bits = static_cast<u32>(std::bit_width(palette_size - 1));
+    size_t packed_size = (TILE_COUNT * bits + 7) / 8;
+    size_t runs_size = 2 + (runs * (bits + 8) + 7) / 8;
+    bool use_runs = runs_size < packed_size;
+
+    s.write_u8(static_cast<u8>(use_runs ? ChunkEncoding::Runs : ChunkEncoding::Packed));
+    s.write_u8(static_cast<u8>(palette_size - 1));
+    for (u32 p = 0; p < palette_size; ++p) {
+        palette[p].serialize(s);
+    }
+
+    BitWriter writer(s);
+    if (use_runs) {
+        s.write_u16(static_cast<u16>(runs));
+        for (size_t i = 0; i < TILE_COUNT;) {
+            size_t end = i + 1;
+            while (end < TILE_COUNT && indices[end] == indices[i]) ++end;
+            writer.write(indices[i], bits);
+            writer.write(static_cast<u32>(end - i - 1), 8);
+            i = end;
+        }
+    } else {
+        for (u8 index : indices) {
+            writer.write(index, bits);
+        }
     }
+    writer.flush();
 }
 
 void Chunk::deserialize(Deserializer& d) {
     origin_.deserialize(d);
-    for (auto& tile : tiles_) {
+
+    auto encoding = static_cast<ChunkEncoding>(d.read_u8());
+    if (encoding == ChunkEncoding::Uniform) {
+        Tile tile;
         tile.deserialize(d);
+        tiles_.fill(tile);
+        fill_planes(tile.flags);
+        return;
+    }
+    if (encoding != ChunkEncoding::Packed && encoding != ChunkEncoding::Runs) {
+        throw DeserializeError("unknown chunk encoding");
     }
+
+    u32 palette_size = u32{d.read_u8()} + 1;
+    std::array<Tile, TILE_COUNT> palette;
+    for (u32 p = 0; p < palette_size; ++p) {
+        palette[p].deserialize(d);
+    }
+    auto bits = static_cast<u32>(std::bit_width(palette_size - 1));
+
+    if (encoding == ChunkEncoding::Runs) {
+        u32 runs = d.read_u16();
+        BitReader reader(d);
+        size_t i = 0;
+        for (u32 r = 0; r < runs; ++r) {
+            u32 index = reader.read(bits);
+            size_t length = size_t{reader.read(8)} + 1;
+            if (index >= palette_size || i + length > TILE_COUNT) {
+                throw DeserializeError("bad chunk run");
+            }
+            std::fill_n(tiles_.begin() + static_cast<std::ptrdiff_t>(i), length, palette[index]);
+            i += length;
+        }
+        if (i != TILE_COUNT) throw DeserializeError("chunk runs don't cover the chunk");
+    } else {
+        BitReader reader(d);
+        for (auto& tile : tiles_) {
+            u32 index = reader.read(bits);
+            if (index >= palette_size) throw DeserializeError("bad chunk palette index");
+            tile = palette[index];
+        }
+    }
+    rebuild_planes();
 }
 
 void Chunk::fill(Tile tile) {
-    for (auto& t : tiles_) {
-        t = tile;
+    tiles_.fill(tile);
+    ++version_;
+    fill_planes(tile.flags);
+}
+
+void Chunk::fill_planes(TileFlags flags) {
+    for (size_t i = 0; i < TILE_PLANE_COUNT; ++i) {
+        bool set = has_flag(flags, plane_flag(static_cast<TilePlane>(i)));
+        planes_[i].fill(set ? static_cast<ChunkRowMask>(~0u) : ChunkRowMask{0});
+    }
+}
+
+void Chunk::rebuild_planes() {
+    for (size_t i = 0; i < TILE_PLANE_COUNT; ++i) {
+        TileFlags flag = plane_flag(static_cast<TilePlane>(i));
+        for (i32 y = 0; y < CHUNK_SIZE; ++y) {
+            u32 row = 0;
+            for (i32 x = 0; x < CHUNK_SIZE; ++x) {
+                if (has_flag(at(x, y).flags, flag)) row |= 1u << x;
+            }
+            planes_[i][static_cast<size_t>(y)] = static_cast<ChunkRowMask>(row);
+        }
     }
 }
 
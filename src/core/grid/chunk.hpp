@@ -5,10 +5,36 @@
 
 namespace city {
 
-// Chunk size in tiles
-constexpr i32 CHUNK_SIZE = 16;
+// Chunk size in tiles (power of two so tile -> chunk is a shift and a mask)
+constexpr i32 CHUNK_SHIFT = 4;
+constexpr i32 CHUNK_SIZE = 1 << CHUNK_SHIFT;
+constexpr i32 CHUNK_MASK = CHUNK_SIZE - 1;
 
-// A chunk is a CHUNK_SIZE x CHUNK_SIZE block of tiles
+// Tile flags mirrored into per-chunk row bitmasks
+enum class TilePlane : u8 {
+    Solid,
+    Opaque,
+    Liquid,
+    Stairs,
+};
+
+constexpr size_t TILE_PLANE_COUNT = 4;
+
+constexpr TileFlags plane_flag(TilePlane plane) {
+    constexpr TileFlags flags[TILE_PLANE_COUNT] = {
+        TileFlags::Solid, TileFlags::Opaque, TileFlags::Liquid, TileFlags::Stairs
+    };
+    return flags[static_cast<size_t>(plane)];
+}
+
+// One bit per tile in a chunk row (bit i = local x i)
+using ChunkRowMask = u16;
+static_assert(sizeof(ChunkRowMask) * 8 == CHUNK_SIZE, "row mask must hold one chunk row");
+
+// A chunk is a CHUNK_SIZE x CHUNK_SIZE block of tiles.
+// Alongside the tiles it keeps one row bitmask per TilePlane, so flag queries can test a
+// whole row with a single load. Tiles are only writable through TileMap (set/fill) and
+// deserialize() to keep the masks in sync.
 class Chunk {
 public:
     Chunk() = default;
@@ -18,18 +44,31 @@ public:
     TilePos origin() const { return origin_; }
 
     // Access tiles by local coordinates (0 to CHUNK_SIZE-1)
-    Tile& at(i32 local_x, i32 local_y) {
-        return tiles_[static_cast<size_t>(local_y * CHUNK_SIZE + local_x)];
-    }
-
     const Tile& at(i32 local_x, i32 local_y) const {
         return tiles_[static_cast<size_t>(local_y * CHUNK_SIZE + local_x)];
     }
 
     // Access by world tile position
-    Tile* at_world(TilePos world_pos);
     const Tile* at_world(TilePos world_pos) const;
 
+    // Bitmask of tiles in local row local_y that have the plane's flag
+    ChunkRowMask row_mask(TilePlane plane, i32 local_y) const {
+        return planes_[static_cast<size_t>(plane)][static_cast<size_t>(local_y)];
+    }
+
+    // All CHUNK_SIZE row masks of a plane
+    const std::array<ChunkRowMask, CHUNK_SIZE>& plane(TilePlane plane) const {
+        return planes_[static_cast<size_t>(plane)];
+    }
+
+    // TileMap::mask_version() at the last change to this chunk's planes (stamped by TileMap)
+    u32 mask_version() const { return mask_version_; }
+
+    // Content version: bumped by set() when a tile changes and by fill(), so replication can
+    // tell which chunks a client hasn't seen yet. TileMap restamps it from its own
+    // map-wide counter (TileMap::content_version).
+    u32 version() const { return version_; }
+
     // Check if world position is within this chunk
     bool contains(TilePos world_pos) const;
 
@@ -39,16 +78,44 @@ public:
     // Get chunk origin from any world position
     static TilePos get_chunk_origin(TilePos world_pos);
 
-    // Serialization
+    // Serialization. Tiles are stored compactly: a uniform chunk as its one tile, otherwise
+    // a palette of the distinct tiles followed by bit-packed palette indices or, when
+    // shorter, bit-packed runs of equal tiles. deserialize throws DeserializeError on
+    // malformed data.
     void serialize(Serializer& s) const;
     void deserialize(Deserializer& d);
 
-    // Fill all tiles with a specific tile
+private:
+    // Writes go through TileMap only, so it can track every change (mask_version, dirty
+    // list, content version) that pathfinding, field of view and replication rely on
+    friend class TileMap;
+
+    // Replace a tile by local coordinates, updating the plane masks and bumping version()
+    // if the tile differs. Returns true if any plane mask changed.
+    bool set(i32 local_x, i32 local_y, Tile tile);
+
+    // Fill all tiles with a specific tile (bumps version())
     void fill(Tile tile);
 
-private:
+    void set_mask_version(u32 version) { mask_version_ = version; }
+    void set_version(u32 version) { version_ = version; }
+
+    // Queued in TileMap's dirty list
+    bool is_dirty() const { return dirty_; }
+    void set_dirty(bool dirty) { dirty_ = dirty; }
+
+    // Recompute all plane masks from tiles_
+    void rebuild_planes();
+
+    // Set every plane mask to all or nothing, as for a chunk of one tile
+    void fill_planes(TileFlags flags);
+
     TilePos origin_{0, 0};
     std::array<Tile, CHUNK_SIZE * CHUNK_SIZE> tiles_{};
+    std::array<std::array<ChunkRowMask, CHUNK_SIZE>, TILE_PLANE_COUNT> planes_{};
+    u32 mask_version_{0};
+    u32 version_{0};
+    bool dirty_{false};
 };
 
 } // namespace city
@@ -0,0 +1,164 @@
+#include "field_of_view.hpp"
+#include <algorithm>
+#include <bit>
+
+namespace city {
+
+namespace {
+
+// Floor of a / b for b > 0
+i32 floor_div(i32 a, i32 b) {
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+} // namespace
+
+void FieldOfView::compute(const TileMap& map, TilePos origin, i32 radius) {
+    origin_ = origin;
+    radius_ = std::max(radius, 0);
+    side_ = 2 * radius_ + 1;
+    words_per_row_ = static_cast<u32>((side_ + 63) / 64);
+
+    auto side = static_cast<u32>(side_);
+    opaque_.assign(static_cast<size_t>(side) * words_per_row_, 0);
+    visible_.assign(opaque_.size(), 0);
+    for (u32 y = 0; y < side; ++y) {
+        for (u32 w = 0; w < words_per_row_; ++w) {
+            i32 count = std::min(64, side_ - static_cast<i32>(w) * 64);
+            TilePos start{origin.x - radius_ + static_cast<i32>(w) * 64,
+                          origin.y - radius_ + static_cast<i32>(y)};
+            opaque_[y * words_per_row_ + w] = map.row_mask(TilePlane::Opaque, start, count);
+        }
+    }
+
+    auto center = static_cast<u32>(radius_);
+    reveal_local(center, center);
+    for (i32 quadrant = 0; quadrant < 4; ++quadrant) {
+        scan_quadrant(quadrant);
+    }
+
+    map_version_ = map.mask_version();
+    chunk_count_ = 0;
+    Recti span = chunk_span();
+    for (i32 cy = span.y; cy < span.y + span.height; ++cy) {
+        for (i32 cx = span.x; cx < span.x + span.width; ++cx) {
+            chunk_count_ += map.chunk_at({cx << CHUNK_SHIFT, cy << CHUNK_SHIFT}) != nullptr;
+        }
+    }
+}
+
+void FieldOfView::scan_quadrant(i32 quadrant) {
+    // (depth, col) to square-local coordinates for the north, east, south and west quadrants
+    auto to_local = [this, quadrant](i32 depth, i32 col) {
+        i32 x = 0;
+        i32 y = 0;
+        switch (quadrant) {
+            case 0: x = col; y = -depth; break;
+            case 1: x = depth; y = col; break;
+            case 2: x = col; y = depth; break;
+            default: x = -depth; y = col; break;
+        }
+        return std::pair{static_cast<u32>(x + radius_), static_cast<u32>(y + radius_)};
+    };
+
+    rows_.clear();
+    rows_.push_back({1, -1, 1, 1, 1});
+    while (!rows_.empty()) {
+        Row row = rows_.back();
+        rows_.pop_back();
+        if (row.depth > radius_) continue;
+
+        // Columns whose centres fall between the slopes, rounding ties outward
+        i32 depth = row.depth;
+        i32 min_col = floor_div(2 * depth * row.start_num + row.start_den, 2 * row.start_den);
+        i32 max_col = -floor_div(row.end_den - 2 * depth * row.end_num, 2 * row.end_den);
+
+        enum { NONE, FLOOR, WALL } previous = NONE;
+        for (i32 col = min_col; col <= max_col; ++col) {
+            auto [x, y] = to_local(depth, col);
+            bool wall = is_opaque_local(x, y);
+
+            // Floor tiles count only when their centre is inside the visible wedge, which is
+            // what makes the result symmetric
+            bool symmetric = col * row.start_den >= depth * row.start_num &&
+                             col * row.end_den <= depth * row.end_num;
+            if ((wall || symmetric) && col * col + depth * depth <= radius_ * radius_) {
+                reveal_local(x, y);
+            }
+
+            if (previous == WALL && !wall) {
+                row.start_num = 2 * col - 1;
+                row.start_den = 2 * depth;
+            }
+            if (previous == FLOOR && wall) {
+                rows_.push_back({depth + 1, row.start_num, row.start_den, 2 * col - 1, 2 * depth});
+            }
+            previous = wall ? WALL : FLOOR;
+        }
+        if (previous == FLOOR) {
+            rows_.push_back({depth + 1, row.start_num, row.start_den, row.end_num, row.end_den});
+        }
+    }
+}
+
+size_t FieldOfView::visible_count() const {
+    size_t count = 0;
+    for (u64 word : visible_) count += static_cast<size_t>(std::popcount(word));
+    return count;
+}
+
+Recti FieldOfView::chunk_span() const {
+    i32 first_x = (origin_.x - radius_) >> CHUNK_SHIFT;
+    i32 first_y = (origin_.y - radius_) >> CHUNK_SHIFT;
+    i32 last_x = (origin_.x + radius_) >> CHUNK_SHIFT;
+    i32 last_y = (origin_.y + radius_) >> CHUNK_SHIFT;
+    return {first_x, first_y, last_x - first_x + 1, last_y - first_y + 1};
+}
+
+bool FieldOfView::is_current(const TileMap& map) const {
+    if (map.mask_version() == map_version_) return true;
+
+    u32 count = 0;
+    Recti span = chunk_span();
+    for (i32 cy = span.y; cy < span.y + span.height; ++cy) {
+        for (i32 cx = span.x; cx < span.x + span.width; ++cx) {
+            const Chunk* chunk = map.chunk_at({cx << CHUNK_SHIFT, cy << CHUNK_SHIFT});
+            if (!chunk) continue;
+            if (chunk->mask_version() > map_version_) return false;
+            ++count;
+        }
+    }
+    return count == chunk_count_;
+}
+
+FieldOfViewCache::FieldOfViewCache(const TileMap& map, size_t capacity)
+    : map_(map), capacity_(std::max<size_t>(capacity, 1)) {}
+
+const FieldOfView& FieldOfViewCache::get(TilePos origin, i32 radius) {
+    ++clock_;
+    auto [it, inserted] = entries_.try_emplace(Key{origin, radius});
+    Entry& entry = it->second;
+    entry.last_used = clock_;
+    if (inserted || !entry.fov.is_current(map_)) {
+        entry.fov.compute(map_, origin, radius);
+        ++computed_;
+    }
+
+    // The entry just used is the newest, so it survives
+    if (entries_.size() > capacity_) {
+        trim();
+    }
+    return entry.fov;
+}
+
+void FieldOfViewCache::trim() {
+    std::vector<u64> ages;
+    ages.reserve(entries_.size());
+    for (const auto& [key, entry] : entries_) ages.push_back(entry.last_used);
+    auto middle = ages.begin() + static_cast<std::ptrdiff_t>(ages.size() / 2);
+    std::nth_element(ages.begin(), middle, ages.end());
+    u64 cutoff = *middle;
+    std::erase_if(entries_, [cutoff](const auto& item) { return item.second.last_used < cutoff; });
+}
+
+} // namespace city
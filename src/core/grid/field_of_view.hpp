@@ -0,0 +1,116 @@
+#pragma once
+
+#include "tilemap.hpp"
+#include <unordered_map>
+#include <vector>
+
+namespace city {
+
+// Tiles visible from an origin within a radius, by symmetric shadowcasting: a floor tile is
+// visible from the origin exactly when the origin would be visible from it, so observation
+// and chat checks agree whichever side asks. Opaque tiles are visible themselves but hide
+// what lies behind them; visibility is cut off at Euclidean distance `radius`.
+//
+// compute() reads opacity for the whole square once, one chunk Opaque row mask per 64 tiles,
+// and reuses its buffers, so a warm FieldOfView doesn't allocate.
+class FieldOfView {
+public:
+    void compute(const TileMap& map, TilePos origin, i32 radius);
+
+    TilePos origin() const { return origin_; }
+    i32 radius() const { return radius_; }
+
+    bool is_visible(TilePos pos) const {
+        auto x = static_cast<u32>(pos.x - origin_.x + radius_);
+        auto y = static_cast<u32>(pos.y - origin_.y + radius_);
+        if (x >= static_cast<u32>(side_) || y >= static_cast<u32>(side_)) return false;
+        return (visible_[y * words_per_row_ + (x >> 6)] >> (x & 63)) & 1;
+    }
+
+    size_t visible_count() const;
+
+    // False once a chunk under the field has changed its planes since compute()
+    // (Chunk::mask_version), or a chunk under it was added or removed
+    bool is_current(const TileMap& map) const;
+
+private:
+    // A row of one octant pair being scanned: tiles at `depth` between two slopes
+    // (start_num / start_den .. end_num / end_den, columns per unit of depth)
+    struct Row {
+        i32 depth;
+        i32 start_num;
+        i32 start_den;
+        i32 end_num;
+        i32 end_den;
+    };
+
+    bool is_opaque_local(u32 x, u32 y) const {
+        return (opaque_[y * words_per_row_ + (x >> 6)] >> (x & 63)) & 1;
+    }
+
+    void reveal_local(u32 x, u32 y) {
+        visible_[y * words_per_row_ + (x >> 6)] |= u64{1} << (x & 63);
+    }
+
+    void scan_quadrant(i32 quadrant);
+
+    // Chunk origins covering the square, as a rect of chunk coordinates
+    Recti chunk_span() const;
+
+    TilePos origin_{0, 0};
+    i32 radius_{0};
+    i32 side_{0};                   // 2 * radius + 1
+    u32 words_per_row_{0};
+    std::vector<u64> opaque_;       // Square around the origin, row-major bit rows
+    std::vector<u64> visible_;      // Same layout
+    std::vector<Row> rows_;         // Scan stack
+
+    u32 map_version_{0};
+    u32 chunk_count_{0};
+};
+
+// FieldOfView results keyed by (origin, radius). A result is recomputed only when a chunk
+// under it changed (FieldOfView::is_current), so viewers standing still, or several
+// viewers on one tile, share one computation. When more than `capacity` results are held
+// the least recently used half is dropped. Returned references stay valid until the next
+// get() or clear(). Not thread-safe.
+class FieldOfViewCache {
+public:
+    explicit FieldOfViewCache(const TileMap& map, size_t capacity = 1024);
+
+    const FieldOfView& get(TilePos origin, i32 radius);
+
+    size_t size() const { return entries_.size(); }
+    void clear() { entries_.clear(); }
+
+    // Number of get() calls that had to run compute() (for profiling)
+    u64 computed() const { return computed_; }
+
+private:
+    struct Key {
+        TilePos origin;
+        i32 radius;
+        bool operator==(const Key&) const = default;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const noexcept {
+            return std::hash<TilePos>{}(key.origin) ^ (static_cast<size_t>(key.radius) << 1);
+        }
+    };
+
+    struct Entry {
+        FieldOfView fov;
+        u64 last_used{0};
+    };
+
+    void trim();
+
+    const TileMap& map_;
+    size_t capacity_;
+    u64 clock_{0};
+    u64 computed_{0};
+    std::unordered_map<Key, Entry, KeyHash> entries_;
+};
+
+} // namespace city
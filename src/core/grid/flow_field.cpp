@@ -0,0 +1,304 @@
+#include "flow_field.hpp"
+#include <algorithm>
+#include <bit>
+
+namespace city {
+
+namespace {
+
+constexpr u32 STRAIGHT_COST = 10;
+constexpr u32 DIAGONAL_COST = 14;
+constexpr u8 NO_DIRECTION = 0xFF;
+
+// ALL_DIRECTIONS alternates straight and diagonal steps
+u32 step_cost(u32 dir) { return (dir & 1) ? DIAGONAL_COST : STRAIGHT_COST; }
+
+} // namespace
+
+FlowField::FlowField(const TileMap& map, TilePos goal) : map_(map), goal_(goal) {
+    update();
+}
+
+FlowField::~FlowField() = default;
+
+TilePos FlowField::chunk_origin(u32 chunk) const {
+    auto columns = static_cast<u32>(chunks_x_);
+    return {area_.x + static_cast<i32>(chunk % columns) * CHUNK_SIZE,
+            area_.y + static_cast<i32>(chunk / columns) * CHUNK_SIZE};
+}
+
+u32 FlowField::neighbourhood(size_t index) const {
+    const u8* up = &open_[index - stride_ - 1];
+    const u8* mid = &open_[index - 1];
+    const u8* down = &open_[index + stride_ - 1];
+    return u32{up[0]} | u32{up[1]} << 1 | u32{up[2]} << 2 |
+           u32{mid[0]} << 3 | u32{mid[1]} << 4 | u32{mid[2]} << 5 |
+           u32{down[0]} << 6 | u32{down[1]} << 7 | u32{down[2]} << 8;
+}
+
+void FlowField::update() {
+    Recti area = map_.has_bounds() ? Recti{0, 0, map_.width(), map_.height()}
+                                   : map_.loaded_area();
+    area.width = (area.width + CHUNK_MASK) & ~CHUNK_MASK;
+    area.height = (area.height + CHUNK_MASK) & ~CHUNK_MASK;
+    bool same_area = area.x == area_.x && area.y == area_.y && area.width == area_.width &&
+                     area.height == area_.height;
+    if (!built_ || !same_area) {
+        rebuild(area);
+        return;
+    }
+
+    last_rebuilt_ = 0;
+    if (map_.mask_version() == synced_version_) return;
+
+    // Chunks stamped after the last sync (or that disappeared) may have new Solid rows
+    changed_.clear();
+    for (u32 c = 0; c < has_chunk_.size(); ++c) {
+        const Chunk* chunk = map_.chunk_at(chunk_origin(c));
+        bool touched = chunk ? chunk->mask_version() > synced_version_ : has_chunk_[c] != 0;
+        if (!touched) continue;
+
+        has_chunk_[c] = chunk != nullptr;
+        read_chunk(c, &changed_);
+    }
+    synced_version_ = map_.mask_version();
+
+    if (!changed_.empty()) {
+        repair();
+    }
+    refresh_directions();
+}
+
+void FlowField::rebuild(Recti area) {
+    area_ = area;
+    built_ = true;
+    synced_version_ = map_.mask_version();
+    chunks_x_ = area.width >> CHUNK_SHIFT;
+    chunks_y_ = area.height >> CHUNK_SHIFT;
+    stride_ = static_cast<size_t>(area.width) + 2;
+    for (u32 dir = 0; dir < 8; ++dir) {
+        offsets_[dir] = ALL_DIRECTIONS[dir].y * static_cast<std::ptrdiff_t>(stride_) +
+                        ALL_DIRECTIONS[dir].x;
+    }
+
+    size_t chunk_count = static_cast<size_t>(chunks_x_) * static_cast<size_t>(chunks_y_);
+    size_t tile_count = stride_ * (static_cast<size_t>(area.height) + 2);
+    solid_rows_.assign(chunk_count * CHUNK_SIZE, ChunkRowMask(~ChunkRowMask{0}));
+    has_chunk_.assign(chunk_count, 0);
+    open_.assign(tile_count, 0);
+    cost_.assign(tile_count, UNREACHABLE);
+    direction_.assign(tile_count, NO_DIRECTION);
+
+    for (u32 c = 0; c < chunk_count; ++c) {
+        has_chunk_[c] = map_.chunk_at(chunk_origin(c)) != nullptr;
+        read_chunk(c, nullptr);
+    }
+
+    pending_.clear();
+    size_t goal = index_of(goal_);
+    if (goal != NO_INDEX && open_[goal]) {
+        cost_[goal] = 0;
+        pending_.push_back({0, goal});
+    }
+    propagate(false);
+
+    dirty_.assign(chunk_count, 1);
+    dirty_list_.resize(chunk_count);
+    for (u32 c = 0; c < chunk_count; ++c) dirty_list_[c] = c;
+    refresh_directions();
+}
+
+void FlowField::read_chunk(u32 chunk, std::vector<size_t>* changed) {
+    TilePos origin = chunk_origin(chunk);
+    for (i32 y = 0; y < CHUNK_SIZE; ++y) {
+        auto row = static_cast<ChunkRowMask>(
+            map_.row_mask(TilePlane::Solid, {origin.x, origin.y + y}, CHUNK_SIZE));
+        ChunkRowMask& stored = solid_rows_[chunk * CHUNK_SIZE + static_cast<u32>(y)];
+        u32 flipped = static_cast<ChunkRowMask>(row ^ stored);
+        stored = row;
+
+        size_t row_start = index_of({origin.x, origin.y + y});
+        for (; flipped != 0; flipped &= flipped - 1) {
+            auto x = static_cast<size_t>(std::countr_zero(flipped));
+            open_[row_start + x] = ((row >> x) & 1) == 0;
+            if (changed) changed->push_back(row_start + x);
+        }
+    }
+}
+
+void FlowField::repair() {
+    // Blocked tiles lose their cost; their neighbours may have relied on them (directly or
+    // through a diagonal they now block). Opened tiles and their neighbours may improve.
+    check_.clear();
+    seeds_.clear();
+    pending_.clear();
+    for (size_t tile : changed_) {
+        mark_dirty(tile);
+        if (!open_[tile]) {
+            cost_[tile] = UNREACHABLE;
+            for (auto offset : offsets_) check_.push_back(tile + static_cast<size_t>(offset));
+        } else {
+            seeds_.push_back(tile);
+            for (auto offset : offsets_) seeds_.push_back(tile + static_cast<size_t>(offset));
+        }
+    }
+
+    // Drop every cost no longer backed by a neighbour with cost exactly one step less
+    // (costs fall strictly toward the goal, so this can't loop)
+    while (!check_.empty()) {
+        size_t tile = check_.back();
+        check_.pop_back();
+        u32 cost = cost_[tile];
+        if (cost == UNREACHABLE || cost == 0) continue;
+
+        bool supported = false;
+        for (u32 moves = ALLOWED_MOVES[neighbourhood(tile)]; moves != 0; moves &= moves - 1) {
+            auto dir = static_cast<u32>(std::countr_zero(moves));
+            u32 next = cost_[tile + static_cast<size_t>(offsets_[dir])];
+            if (next != UNREACHABLE && next + step_cost(dir) == cost) {
+                supported = true;
+                break;
+            }
+        }
+        if (supported) continue;
+
+        cost_[tile] = UNREACHABLE;
+        mark_dirty(tile);
+        seeds_.push_back(tile);
+        for (auto offset : offsets_) check_.push_back(tile + static_cast<size_t>(offset));
+    }
+
+    // Reseed from the surviving costs around everything that changed
+    size_t goal = index_of(goal_);
+    for (size_t tile : seeds_) {
+        if (!open_[tile]) continue;
+
+        u32 best = tile == goal ? 0 : UNREACHABLE;
+        for (u32 moves = ALLOWED_MOVES[neighbourhood(tile)]; moves != 0; moves &= moves - 1) {
+            auto dir = static_cast<u32>(std::countr_zero(moves));
+            u32 next = cost_[tile + static_cast<size_t>(offsets_[dir])];
+            if (next != UNREACHABLE) best = std::min(best, next + step_cost(dir));
+        }
+        if (best < cost_[tile]) {
+            cost_[tile] = best;
+            mark_dirty(tile);
+            pending_.push_back({best, tile});
+        }
+    }
+    std::sort(pending_.begin(), pending_.end());
+    propagate(true);
+}
+
+void FlowField::propagate(bool track_dirty) {
+    // Bucket queue keyed by cost modulo its size: a step costs at most DIAGONAL_COST, so
+    // every queued cost is within that of the one being settled. Pending seeds join their
+    // bucket when the sweep reaches their cost.
+    static_assert(DIAGONAL_COST < std::tuple_size_v<decltype(buckets_)>);
+    size_t next_seed = 0;
+    size_t queued = 0;
+    u32 d = 0;
+    while (queued > 0 || next_seed < pending_.size()) {
+        if (queued == 0) d = std::max(d, pending_[next_seed].first);
+
+        auto& bucket = buckets_[d % buckets_.size()];
+        for (; next_seed < pending_.size() && pending_[next_seed].first == d; ++next_seed) {
+            bucket.push_back(pending_[next_seed].second);
+            ++queued;
+        }
+
+        queued -= bucket.size();
+        for (size_t tile : bucket) {
+            if (cost_[tile] != d) continue;     // Reached more cheaply since it was queued
+
+            for (u32 moves = ALLOWED_MOVES[neighbourhood(tile)]; moves != 0;
+                 moves &= moves - 1) {
+                auto dir = static_cast<u32>(std::countr_zero(moves));
+                size_t next = tile + static_cast<size_t>(offsets_[dir]);
+                u32 next_cost = d + step_cost(dir);
+                if (next_cost < cost_[next]) {
+                    cost_[next] = next_cost;
+                    if (track_dirty) mark_dirty(next);
+                    buckets_[next_cost % buckets_.size()].push_back(next);
+                    ++queued;
+                }
+            }
+        }
+        bucket.clear();
+        ++d;
+    }
+    pending_.clear();
+}
+
+void FlowField::mark_dirty(size_t index) {
+    // A tile's direction reads its 3x3 neighbourhood, which can reach into adjacent chunks
+    auto x = static_cast<i32>(index % stride_) - 1;
+    auto y = static_cast<i32>(index / stride_) - 1;
+    i32 first_cx = std::max(x - 1, 0) >> CHUNK_SHIFT;
+    i32 last_cx = std::min(x + 1, area_.width - 1) >> CHUNK_SHIFT;
+    i32 first_cy = std::max(y - 1, 0) >> CHUNK_SHIFT;
+    i32 last_cy = std::min(y + 1, area_.height - 1) >> CHUNK_SHIFT;
+    for (i32 cy = first_cy; cy <= last_cy; ++cy) {
+        for (i32 cx = first_cx; cx <= last_cx; ++cx) {
+            auto c = static_cast<u32>(cy * chunks_x_ + cx);
+            if (!dirty_[c]) {
+                dirty_[c] = 1;
+                dirty_list_.push_back(c);
+            }
+        }
+    }
+}
+
+void FlowField::refresh_directions() {
+    // Each tile steps to the legal neighbour that minimises neighbour cost plus step cost,
+    // which is exactly one step along a shortest path
+    for (u32 c : dirty_list_) {
+        TilePos origin = chunk_origin(c);
+        for (i32 y = 0; y < CHUNK_SIZE; ++y) {
+            size_t row_start = index_of({origin.x, origin.y + y});
+            for (size_t x = 0; x < CHUNK_SIZE; ++x) {
+                size_t tile = row_start + x;
+                u8 best_dir = NO_DIRECTION;
+                if (cost_[tile] != UNREACHABLE && cost_[tile] != 0) {
+                    u32 best = UNREACHABLE;
+                    u32 moves = ALLOWED_MOVES[neighbourhood(tile)];
+                    for (; moves != 0; moves &= moves - 1) {
+                        auto dir = static_cast<u32>(std::countr_zero(moves));
+                        u32 next = cost_[tile + static_cast<size_t>(offsets_[dir])];
+                        if (next != UNREACHABLE && next + step_cost(dir) < best) {
+                            best = next + step_cost(dir);
+                            best_dir = static_cast<u8>(dir);
+                        }
+                    }
+                }
+                direction_[tile] = best_dir;
+            }
+        }
+        dirty_[c] = 0;
+    }
+    last_rebuilt_ = static_cast<u32>(dirty_list_.size());
+    dirty_list_.clear();
+}
+
+FlowFieldCache::FlowFieldCache(const TileMap& map, size_t capacity)
+    : map_(map), capacity_(std::max<size_t>(capacity, 1)) {}
+
+std::shared_ptr<const FlowField> FlowFieldCache::get(TilePos goal) {
+    ++clock_;
+    for (Entry& entry : entries_) {
+        if (entry.field->goal() == goal) {
+            entry.last_used = clock_;
+            entry.field->update();
+            return entry.field;
+        }
+    }
+
+    if (entries_.size() >= capacity_) {
+        auto oldest = std::min_element(entries_.begin(), entries_.end(),
+            [](const Entry& a, const Entry& b) { return a.last_used < b.last_used; });
+        entries_.erase(oldest);
+    }
+    entries_.push_back({std::make_shared<FlowField>(map_, goal), clock_});
+    return entries_.back().field;
+}
+
+} // namespace city
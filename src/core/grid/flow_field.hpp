@@ -0,0 +1,146 @@
+#pragma once
+
+#include "tilemap.hpp"
+#include <array>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace city {
+
+// Flow field toward one goal tile: an integration field holding every tile's path cost to
+// the goal (Dijkstra from the goal, 10 per straight and 14 per diagonal step, no corner
+// cutting, as Pathfinder), and a direction field holding the step to take from each tile.
+// Any number of agents heading to the same goal then cost one lookup each per tick instead
+// of a search each.
+//
+// The field covers the map bounds, or the loaded chunks for unbounded maps. update()
+// follows TileMap::mask_version: only chunks stamped since the last sync are re-read, the
+// integration field is repaired around the tiles that actually changed, and directions
+// are recomputed for the chunks whose costs moved. Lookups are const and may run on many
+// threads at once, but not while update() runs.
+class FlowField {
+public:
+    static constexpr u32 UNREACHABLE = std::numeric_limits<u32>::max();
+
+    FlowField(const TileMap& map, TilePos goal);
+    ~FlowField();
+
+    FlowField(const FlowField&) = delete;
+    FlowField& operator=(const FlowField&) = delete;
+
+    // Bring the field up to date with the map (the constructor builds it)
+    void update();
+
+    TilePos goal() const { return goal_; }
+
+    // Path cost from pos to the goal, or UNREACHABLE (also for blocked tiles and tiles
+    // outside the field)
+    u32 cost_at(TilePos pos) const {
+        size_t index = index_of(pos);
+        return index == NO_INDEX ? UNREACHABLE : cost_[index];
+    }
+
+    // Step toward the goal from pos; {0, 0} at the goal and wherever cost_at is UNREACHABLE
+    TilePos direction_at(TilePos pos) const {
+        size_t index = index_of(pos);
+        if (index == NO_INDEX || direction_[index] >= 8) return {0, 0};
+        return ALL_DIRECTIONS[direction_[index]];
+    }
+
+    // Chunks whose directions were recomputed by the last update()
+    u32 last_rebuilt_chunks() const { return last_rebuilt_; }
+
+private:
+    static constexpr size_t NO_INDEX = std::numeric_limits<size_t>::max();
+
+    // Index into the padded per-tile arrays, or NO_INDEX outside the field
+    size_t index_of(TilePos pos) const {
+        auto x = static_cast<u32>(pos.x - area_.x);
+        auto y = static_cast<u32>(pos.y - area_.y);
+        if (x >= static_cast<u32>(area_.width) || y >= static_cast<u32>(area_.height)) {
+            return NO_INDEX;
+        }
+        return (static_cast<size_t>(y) + 1) * stride_ + x + 1;
+    }
+
+    void rebuild(Recti area);
+
+    // Re-read a chunk's Solid rows into open_; appends the tiles whose passability changed
+    void read_chunk(u32 chunk, std::vector<size_t>* changed);
+
+    // Fix the integration field after the tiles in changed_ flipped passability
+    void repair();
+
+    // Dijkstra from the pending seeds (sorted by cost) over the whole field
+    void propagate(bool track_dirty);
+
+    // 3x3 open-tile neighbourhood of a tile (see ALLOWED_MOVES)
+    u32 neighbourhood(size_t index) const;
+
+    // Flag the chunks whose directions may depend on this tile's cost or passability
+    void mark_dirty(size_t index);
+
+    void refresh_directions();
+
+    TilePos chunk_origin(u32 chunk) const;
+
+    const TileMap& map_;
+    TilePos goal_;
+    Recti area_;                    // Rounded out to whole chunks
+    i32 chunks_x_{0};
+    i32 chunks_y_{0};
+    size_t stride_{0};              // Padded row length
+    std::array<std::ptrdiff_t, 8> offsets_{};  // Index delta per ALL_DIRECTIONS step
+    bool built_{false};
+    u32 synced_version_{0};
+    u32 last_rebuilt_{0};
+
+    std::vector<ChunkRowMask> solid_rows_;  // CHUNK_SIZE rows per chunk
+    std::vector<u8> has_chunk_;
+
+    // Per tile, row-major with a one-tile closed border so neighbours need no bounds checks
+    std::vector<u8> open_;
+    std::vector<u32> cost_;
+    std::vector<u8> direction_;     // ALL_DIRECTIONS index, or 0xFF for none
+
+    std::vector<u8> dirty_;         // Per chunk: directions need recomputing
+    std::vector<u32> dirty_list_;
+
+    // Update scratch
+    std::vector<size_t> changed_;
+    std::vector<size_t> check_;
+    std::vector<size_t> seeds_;
+    std::vector<std::pair<u32, size_t>> pending_;
+    std::array<std::vector<size_t>, 16> buckets_;
+};
+
+// Flow fields for the few goals many agents share (assembly points, exits, events), built
+// on first request and kept until more than `capacity` goals are in use, when the least
+// recently requested one is dropped. Fields are shared, so a caller holding one (say, per
+// crowd goal across ticks) keeps it alive past eviction; an evicted field is no longer
+// updated with the map. Not thread-safe: fetch the fields before a parallel steering pass,
+// then share them read-only.
+class FlowFieldCache {
+public:
+    explicit FlowFieldCache(const TileMap& map, size_t capacity = 8);
+
+    // Field toward goal, brought up to date with the map
+    std::shared_ptr<const FlowField> get(TilePos goal);
+
+    size_t size() const { return entries_.size(); }
+    void clear() { entries_.clear(); }
+
+private:
+    struct Entry {
+        std::shared_ptr<FlowField> field;
+        u64 last_used;
+    };
+
+    const TileMap& map_;
+    size_t capacity_;
+    u64 clock_{0};
+    std::vector<Entry> entries_;
+};
+
+} // namespace city
@@ -0,0 +1,601 @@
+#include "hierarchical_pathfinder.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <limits>
+
+namespace city {
+
+namespace {
+
+constexpr u32 STRAIGHT_COST = 10;
+constexpr u32 DIAGONAL_COST = 14;
+constexpr u32 INFINITE_COST = std::numeric_limits<u32>::max();
+
+constexpr size_t CLUSTER_CELLS = CHUNK_SIZE * CHUNK_SIZE;
+
+// Four borders of CHUNK_SIZE tiles each can't produce more entrance tiles than this
+constexpr u32 MAX_CLUSTER_NODES = 4 * CHUNK_SIZE;
+
+constexpr u32 INVALID_NODE = std::numeric_limits<u32>::max();
+constexpr u32 START_NODE = INVALID_NODE - 1;
+
+// Openings at least this wide get an entrance at each end instead of one in the middle
+constexpr i32 LONG_OPENING = 6;
+
+constexpr u8 NO_DIRECTION = 0xFF;
+
+using ClusterRows = std::array<ChunkRowMask, CHUNK_SIZE>;
+
+u8 local_index(i32 x, i32 y) { return static_cast<u8>(y * CHUNK_SIZE + x); }
+i32 local_x(u8 index) { return index & CHUNK_MASK; }
+i32 local_y(u8 index) { return index >> CHUNK_SHIFT; }
+
+bool blocked_at(const ClusterRows& rows, i32 x, i32 y) {
+    if (x < 0 || y < 0 || x >= CHUNK_SIZE || y >= CHUNK_SIZE) return true;
+    return (rows[static_cast<size_t>(y)] >> x) & 1;
+}
+
+u32 octile_distance(TilePos a, TilePos b) {
+    auto dx = static_cast<u32>(std::abs(a.x - b.x));
+    auto dy = static_cast<u32>(std::abs(a.y - b.y));
+    return STRAIGHT_COST * std::max(dx, dy) + (DIAGONAL_COST - STRAIGHT_COST) * std::min(dx, dy);
+}
+
+// Index into ALL_DIRECTIONS of a unit step
+u8 direction_index(TilePos step) {
+    for (u8 i = 0; i < 8; ++i) {
+        if (ALL_DIRECTIONS[i] == step) return i;
+    }
+    return NO_DIRECTION;
+}
+
+} // namespace
+
+struct HierarchicalPathfinder::Cluster {
+    struct Edge {
+        u8 to;                  // Local node index
+        u16 path_length;        // Steps in the stored path
+        u32 cost;
+        u32 path_offset;        // Into steps
+    };
+
+    ClusterRows blocked;
+    bool has_chunk{false};
+    bool dirty{false};
+    std::vector<u8> east_entrances;     // Local y of entrances shared with the east neighbour
+    std::vector<u8> south_entrances;    // Local x of entrances shared with the south neighbour
+    std::vector<u8> nodes;              // Local tile index of each abstract node
+    std::vector<TilePos> positions;     // World position of each node
+    std::vector<u32> edge_begin;        // Edges of node i: [edge_begin[i], edge_begin[i + 1])
+    std::vector<Edge> edges;
+    std::vector<u8> steps;              // ALL_DIRECTIONS indices of every edge's path
+};
+
+// Dijkstra over the tiles of one cluster
+struct HierarchicalPathfinder::LocalSearch {
+    void run(const ClusterRows& blocked, u8 source);
+
+    // Append the steps from the source to target (ALL_DIRECTIONS indices)
+    void path_to(u8 target, std::vector<u8>& out) const {
+        size_t begin = out.size();
+        for (u8 cell = target; arrived_by[cell] != NO_DIRECTION;) {
+            u8 dir = arrived_by[cell];
+            out.push_back(dir);
+            TilePos step = ALL_DIRECTIONS[dir];
+            cell = local_index(local_x(cell) - step.x, local_y(cell) - step.y);
+        }
+        std::reverse(out.begin() + static_cast<std::ptrdiff_t>(begin), out.end());
+    }
+
+    std::array<u32, CLUSTER_CELLS> dist;
+    std::array<u8, CLUSTER_CELLS> arrived_by;     // Direction of the last step into each cell
+
+    // Bucket queue keyed by distance modulo its size: steps cost at most DIAGONAL_COST, so
+    // every queued distance is within DIAGONAL_COST of the one being settled
+    std::array<std::vector<u8>, 16> buckets;
+};
+
+void HierarchicalPathfinder::LocalSearch::run(const ClusterRows& blocked, u8 source) {
+    static_assert(DIAGONAL_COST < 16);
+    static_assert(ALL_DIRECTIONS[1].x != 0 && ALL_DIRECTIONS[1].y != 0, "diagonals are odd");
+    dist.fill(INFINITE_COST);
+    arrived_by.fill(NO_DIRECTION);
+
+    // Open tiles padded by a closed tile on every side, so neighbours need no bounds checks
+    std::array<u32, CHUNK_SIZE + 2> open{};
+    for (size_t y = 0; y < CHUNK_SIZE; ++y) {
+        open[y + 1] = static_cast<u32>(static_cast<ChunkRowMask>(~blocked[y])) << 1;
+    }
+
+    dist[source] = 0;
+    buckets[0].push_back(source);
+    size_t queued = 1;
+
+    for (u32 d = 0; queued > 0; ++d) {
+        auto& bucket = buckets[d % buckets.size()];
+        queued -= bucket.size();
+        for (u8 cell : bucket) {
+            if (dist[cell] != d) continue;      // Reached more cheaply since it was queued
+
+            i32 x = local_x(cell);
+            auto y = static_cast<size_t>(local_y(cell));
+            u32 neighbourhood = ((open[y] >> x) & 7) | (((open[y + 1] >> x) & 7) << 3) |
+                                (((open[y + 2] >> x) & 7) << 6);
+            for (u32 moves = ALLOWED_MOVES[neighbourhood]; moves != 0; moves &= moves - 1) {
+                auto dir = static_cast<u8>(std::countr_zero(moves));
+                TilePos step = ALL_DIRECTIONS[dir];
+                u8 next = static_cast<u8>(cell + step.y * CHUNK_SIZE + step.x);
+                u32 next_dist = d + ((dir & 1) ? DIAGONAL_COST : STRAIGHT_COST);
+                if (next_dist < dist[next]) {
+                    dist[next] = next_dist;
+                    arrived_by[next] = dir;
+                    buckets[next_dist % buckets.size()].push_back(next);
+                    ++queued;
+                }
+            }
+        }
+        bucket.clear();
+    }
+}
+
+// A* over the abstract graph. Node ids are cluster * MAX_CLUSTER_NODES + local node index;
+// the goal gets the id just past the last cluster.
+//
+// Costs are integers and the octile heuristic is consistent, so f never decreases and the
+// open list is a ring of f buckets instead of a binary heap (whose pops were most of the
+// query time on large maps). An edge raises f by at most twice its cost, and no edge is
+// longer than a path through every tile of a chunk, which bounds the live f range.
+struct HierarchicalPathfinder::AbstractSearch {
+    struct NodeState {
+        u32 stamp{0};
+        u32 g{INFINITE_COST};
+        u32 parent{INVALID_NODE};
+        bool closed{false};
+    };
+
+    struct OpenEntry {
+        u32 g;
+        u32 id;
+    };
+
+    static constexpr size_t BUCKET_COUNT = 8192;
+    static_assert(2 * CLUSTER_CELLS * DIAGONAL_COST < BUCKET_COUNT);
+
+    void begin(size_t node_count, u32 min_f) {
+        if (nodes.size() < node_count) {
+            nodes.resize(node_count);
+        }
+        if (++stamp == 0) {
+            for (auto& node : nodes) node.stamp = 0;
+            stamp = 1;
+        }
+        if (buckets.empty()) {
+            buckets.resize(BUCKET_COUNT);
+        }
+        for (size_t index : used_buckets) buckets[index].clear();
+        used_buckets.clear();
+        open_count = 0;
+        current_f = min_f;
+    }
+
+    void relax(u32 id, u32 g, u32 h, u32 parent) {
+        NodeState& node = nodes[id];
+        if (node.stamp != stamp) {
+            node = NodeState{stamp, INFINITE_COST, INVALID_NODE, false};
+        }
+        if (node.closed || g >= node.g) return;
+
+        node.g = g;
+        node.parent = parent;
+        size_t index = std::max(g + h, current_f) % BUCKET_COUNT;
+        if (buckets[index].empty()) used_buckets.push_back(index);
+        buckets[index].push_back({g, id});
+        ++open_count;
+    }
+
+    // Lowest-f open entry (latest pushed among equals); open_count must be non-zero
+    OpenEntry pop() {
+        while (buckets[current_f % BUCKET_COUNT].empty()) ++current_f;
+        auto& bucket = buckets[current_f % BUCKET_COUNT];
+        OpenEntry entry = bucket.back();
+        bucket.pop_back();
+        --open_count;
+        return entry;
+    }
+
+    std::vector<NodeState> nodes;
+    std::vector<std::vector<OpenEntry>> buckets;
+    std::vector<size_t> used_buckets;   // Buckets pushed to since begin()
+    size_t open_count{0};
+    u32 current_f{0};
+    std::vector<u32> route;         // Reconstructed abstract path (node ids, start to goal)
+    std::vector<u8> steps;          // Scratch for start-side local paths
+    u32 stamp{0};
+};
+
+HierarchicalPathfinder::HierarchicalPathfinder(const TileMap& map)
+    : map_(map),
+      local_(std::make_unique<LocalSearch>()),
+      goal_local_(std::make_unique<LocalSearch>()),
+      search_(std::make_unique<AbstractSearch>()) {}
+
+HierarchicalPathfinder::~HierarchicalPathfinder() = default;
+
+size_t HierarchicalPathfinder::node_count() const {
+    size_t count = 0;
+    for (const auto& cluster : clusters_) count += cluster.nodes.size();
+    return count;
+}
+
+size_t HierarchicalPathfinder::edge_count() const {
+    size_t count = 0;
+    for (const auto& cluster : clusters_) count += cluster.edges.size();
+    return count;
+}
+
+TilePos HierarchicalPathfinder::cluster_origin(u32 cluster) const {
+    auto columns = static_cast<u32>(clusters_x_);
+    return {area_.x + static_cast<i32>(cluster % columns) * CHUNK_SIZE,
+            area_.y + static_cast<i32>(cluster / columns) * CHUNK_SIZE};
+}
+
+void HierarchicalPathfinder::update() {
+    Recti area = map_.has_bounds() ? Recti{0, 0, map_.width(), map_.height()}
+                                   : map_.loaded_area();
+    bool same_area = area.x == area_.x && area.y == area_.y && area.width == area_.width &&
+                     area.height == area_.height;
+    if (!built_ || !same_area) {
+        rebuild_all(area);
+        return;
+    }
+
+    last_rebuilt_ = 0;
+    if (map_.mask_version() == synced_version_) return;
+
+    // Chunks stamped after the last sync (or that disappeared) may have new Solid rows
+    changed_.clear();
+    for (u32 c = 0; c < clusters_.size(); ++c) {
+        const Chunk* chunk = map_.chunk_at(cluster_origin(c));
+        bool touched = chunk ? chunk->mask_version() > synced_version_ : clusters_[c].has_chunk;
+        if (!touched) continue;
+
+        clusters_[c].has_chunk = chunk != nullptr;
+        if (refresh_blocked(c)) {
+            changed_.push_back(c);
+        }
+    }
+
+    // A changed chunk needs new edges; its neighbours only if a shared entrance moved
+    dirty_.clear();
+    auto mark = [this](u32 c) {
+        if (!clusters_[c].dirty) {
+            clusters_[c].dirty = true;
+            dirty_.push_back(c);
+        }
+    };
+    auto columns = static_cast<u32>(clusters_x_);
+    auto rows = static_cast<u32>(clusters_y_);
+    for (u32 c : changed_) {
+        u32 cx = c % columns;
+        u32 cy = c / columns;
+        mark(c);
+        if (cx > 0 && refresh_east_border(c - 1)) mark(c - 1);
+        if (cx + 1 < columns && refresh_east_border(c)) mark(c + 1);
+        if (cy > 0 && refresh_south_border(c - columns)) mark(c - columns);
+        if (cy + 1 < rows && refresh_south_border(c)) mark(c + columns);
+    }
+
+    for (u32 c : dirty_) {
+        rebuild_cluster(c);
+        clusters_[c].dirty = false;
+    }
+    last_rebuilt_ = static_cast<u32>(dirty_.size());
+    synced_version_ = map_.mask_version();
+}
+
+void HierarchicalPathfinder::rebuild_all(Recti area) {
+    area_ = area;
+    built_ = true;
+    synced_version_ = map_.mask_version();
+    clusters_x_ = (area.width + CHUNK_MASK) >> CHUNK_SHIFT;
+    clusters_y_ = (area.height + CHUNK_MASK) >> CHUNK_SHIFT;
+
+    clusters_.clear();
+    clusters_.resize(static_cast<size_t>(clusters_x_) * static_cast<size_t>(clusters_y_));
+    for (u32 c = 0; c < clusters_.size(); ++c) {
+        clusters_[c].has_chunk = map_.chunk_at(cluster_origin(c)) != nullptr;
+        refresh_blocked(c);
+    }
+
+    auto columns = static_cast<u32>(clusters_x_);
+    auto rows = static_cast<u32>(clusters_y_);
+    for (u32 c = 0; c < clusters_.size(); ++c) {
+        if (c % columns + 1 < columns) refresh_east_border(c);
+        if (c / columns + 1 < rows) refresh_south_border(c);
+    }
+    for (u32 c = 0; c < clusters_.size(); ++c) {
+        rebuild_cluster(c);
+    }
+    last_rebuilt_ = static_cast<u32>(clusters_.size());
+}
+
+bool HierarchicalPathfinder::refresh_blocked(u32 cluster) {
+    TilePos origin = cluster_origin(cluster);
+    ClusterRows rows;
+    for (i32 y = 0; y < CHUNK_SIZE; ++y) {
+        rows[static_cast<size_t>(y)] = static_cast<ChunkRowMask>(
+            map_.row_mask(TilePlane::Solid, {origin.x, origin.y + y}, CHUNK_SIZE));
+    }
+
+    bool changed = rows != clusters_[cluster].blocked;
+    clusters_[cluster].blocked = rows;
+    return changed;
+}
+
+namespace {
+
+// Entrance offsets along a border given which offsets are open on both sides
+template<typename IsOpen>
+std::vector<u8> find_entrances(IsOpen&& is_open) {
+    std::vector<u8> entrances;
+    i32 run_start = -1;
+    for (i32 i = 0; i <= CHUNK_SIZE; ++i) {
+        bool open = i < CHUNK_SIZE && is_open(i);
+        if (open && run_start < 0) {
+            run_start = i;
+        } else if (!open && run_start >= 0) {
+            i32 run_end = i - 1;
+            if (run_end - run_start + 1 >= LONG_OPENING) {
+                entrances.push_back(static_cast<u8>(run_start));
+                entrances.push_back(static_cast<u8>(run_end));
+            } else {
+                entrances.push_back(static_cast<u8>((run_start + run_end) / 2));
+            }
+            run_start = -1;
+        }
+    }
+    return entrances;
+}
+
+} // namespace
+
+bool HierarchicalPathfinder::refresh_east_border(u32 cluster) {
+    const ClusterRows& west = clusters_[cluster].blocked;
+    const ClusterRows& east = clusters_[cluster + 1].blocked;
+    auto entrances = find_entrances([&](i32 y) {
+        return !blocked_at(west, CHUNK_SIZE - 1, y) && !blocked_at(east, 0, y);
+    });
+
+    bool changed = entrances != clusters_[cluster].east_entrances;
+    clusters_[cluster].east_entrances = std::move(entrances);
+    return changed;
+}
+
+bool HierarchicalPathfinder::refresh_south_border(u32 cluster) {
+    const ClusterRows& north = clusters_[cluster].blocked;
+    const ClusterRows& south = clusters_[cluster + static_cast<u32>(clusters_x_)].blocked;
+    auto entrances = find_entrances([&](i32 x) {
+        return !blocked_at(north, x, CHUNK_SIZE - 1) && !blocked_at(south, x, 0);
+    });
+
+    bool changed = entrances != clusters_[cluster].south_entrances;
+    clusters_[cluster].south_entrances = std::move(entrances);
+    return changed;
+}
+
+void HierarchicalPathfinder::rebuild_cluster(u32 cluster) {
+    auto columns = static_cast<u32>(clusters_x_);
+    u32 cx = cluster % columns;
+    u32 cy = cluster / columns;
+    Cluster& c = clusters_[cluster];
+
+    // Entrance tiles from all four borders (corner tiles can appear twice)
+    TilePos origin = cluster_origin(cluster);
+    std::array<bool, CLUSTER_CELLS> seen{};
+    c.nodes.clear();
+    c.positions.clear();
+    auto add_node = [&](i32 x, i32 y) {
+        u8 index = local_index(x, y);
+        if (!seen[index]) {
+            seen[index] = true;
+            c.nodes.push_back(index);
+            c.positions.push_back(origin + TilePos{x, y});
+        }
+    };
+    for (u8 y : c.east_entrances) add_node(CHUNK_SIZE - 1, y);
+    for (u8 x : c.south_entrances) add_node(x, CHUNK_SIZE - 1);
+    if (cx > 0) {
+        for (u8 y : clusters_[cluster - 1].east_entrances) add_node(0, y);
+    }
+    if (cy > 0) {
+        for (u8 x : clusters_[cluster - columns].south_entrances) add_node(x, 0);
+    }
+
+    // Shortest in-chunk path between every pair of entrance tiles
+    c.edges.clear();
+    c.steps.clear();
+    c.edge_begin.assign(c.nodes.size() + 1, 0);
+    for (size_t i = 0; i < c.nodes.size(); ++i) {
+        c.edge_begin[i] = static_cast<u32>(c.edges.size());
+        local_->run(c.blocked, c.nodes[i]);
+        for (size_t j = 0; j < c.nodes.size(); ++j) {
+            if (i == j || local_->dist[c.nodes[j]] == INFINITE_COST) continue;
+
+            auto offset = static_cast<u32>(c.steps.size());
+            local_->path_to(c.nodes[j], c.steps);
+            c.edges.push_back({static_cast<u8>(j), static_cast<u16>(c.steps.size() - offset),
+                               local_->dist[c.nodes[j]], offset});
+        }
+    }
+    c.edge_begin[c.nodes.size()] = static_cast<u32>(c.edges.size());
+}
+
+u32 HierarchicalPathfinder::find_node(u32 cluster, u8 local) const {
+    const auto& nodes = clusters_[cluster].nodes;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if (nodes[i] == local) return cluster * MAX_CLUSTER_NODES + static_cast<u32>(i);
+    }
+    return INVALID_NODE;
+}
+
+bool HierarchicalPathfinder::find_path(TilePos start, TilePos goal,
+                                       std::vector<TilePos>& out_path) {
+    out_path.clear();
+    last_expanded_ = 0;
+    update();
+
+    if (!area_.contains(Vec2i{start.x, start.y}) || !area_.contains(Vec2i{goal.x, goal.y})) {
+        return false;
+    }
+
+    auto columns = static_cast<u32>(clusters_x_);
+    auto rows = static_cast<u32>(clusters_y_);
+    auto cluster_of = [&](TilePos pos) {
+        return static_cast<u32>((pos.y - area_.y) >> CHUNK_SHIFT) * columns +
+               static_cast<u32>((pos.x - area_.x) >> CHUNK_SHIFT);
+    };
+    auto local_of = [&](TilePos pos) {
+        return local_index((pos.x - area_.x) & CHUNK_MASK, (pos.y - area_.y) & CHUNK_MASK);
+    };
+
+    u32 start_cluster = cluster_of(start);
+    u32 goal_cluster = cluster_of(goal);
+    u8 start_local = local_of(start);
+    u8 goal_local = local_of(goal);
+    if (blocked_at(clusters_[start_cluster].blocked, local_x(start_local), local_y(start_local)) ||
+        blocked_at(clusters_[goal_cluster].blocked, local_x(goal_local), local_y(goal_local))) {
+        return false;
+    }
+
+    auto node_pos = [&](u32 id) {
+        return clusters_[id / MAX_CLUSTER_NODES].positions[id % MAX_CLUSTER_NODES];
+    };
+
+    // Connect start and goal to the entrances of their own chunks
+    local_->run(clusters_[start_cluster].blocked, start_local);
+    goal_local_->run(clusters_[goal_cluster].blocked, goal_local);
+
+    AbstractSearch& search = *search_;
+    const u32 goal_id = static_cast<u32>(clusters_.size()) * MAX_CLUSTER_NODES;
+    search.begin(static_cast<size_t>(goal_id) + 1, octile_distance(start, goal));
+
+    if (start_cluster == goal_cluster && local_->dist[goal_local] != INFINITE_COST) {
+        search.relax(goal_id, local_->dist[goal_local], 0, START_NODE);
+    }
+    const Cluster& first = clusters_[start_cluster];
+    for (size_t i = 0; i < first.nodes.size(); ++i) {
+        u32 dist = local_->dist[first.nodes[i]];
+        if (dist == INFINITE_COST) continue;
+        u32 id = start_cluster * MAX_CLUSTER_NODES + static_cast<u32>(i);
+        search.relax(id, dist, octile_distance(node_pos(id), goal), START_NODE);
+    }
+
+    bool found = false;
+    while (search.open_count > 0) {
+        auto entry = search.pop();
+
+        auto& state = search.nodes[entry.id];
+        if (state.closed || entry.g != state.g) continue;
+        state.closed = true;
+        ++last_expanded_;
+
+        if (entry.id == goal_id) {
+            found = true;
+            break;
+        }
+
+        u32 cluster = entry.id / MAX_CLUSTER_NODES;
+        u32 node = entry.id % MAX_CLUSTER_NODES;
+        const Cluster& c = clusters_[cluster];
+        u8 local = c.nodes[node];
+
+        if (cluster == goal_cluster && goal_local_->dist[local] != INFINITE_COST) {
+            search.relax(goal_id, entry.g + goal_local_->dist[local], 0, entry.id);
+        }
+
+        for (u32 e = c.edge_begin[node]; e < c.edge_begin[node + 1]; ++e) {
+            u32 to = cluster * MAX_CLUSTER_NODES + c.edges[e].to;
+            search.relax(to, entry.g + c.edges[e].cost, octile_distance(node_pos(to), goal),
+                         entry.id);
+        }
+
+        // Step across the chunk border to the paired entrance tile
+        i32 x = local_x(local);
+        i32 y = local_y(local);
+        u32 cx = cluster % columns;
+        u32 cy = cluster / columns;
+        auto cross = [&](bool exists, u32 neighbour, i32 nx, i32 ny) {
+            if (!exists) return;
+            u32 to = find_node(neighbour, local_index(nx, ny));
+            if (to == INVALID_NODE) return;
+            search.relax(to, entry.g + STRAIGHT_COST, octile_distance(node_pos(to), goal),
+                         entry.id);
+        };
+        if (x == CHUNK_SIZE - 1) cross(cx + 1 < columns, cluster + 1, 0, y);
+        if (x == 0) cross(cx > 0, cluster - 1, CHUNK_SIZE - 1, y);
+        if (y == CHUNK_SIZE - 1) cross(cy + 1 < rows, cluster + columns, x, 0);
+        if (y == 0) cross(cy > 0, cluster - columns, x, CHUNK_SIZE - 1);
+    }
+    if (!found) return false;
+
+    // Abstract route, start side first
+    search.route.clear();
+    for (u32 id = search.nodes[goal_id].parent; id != START_NODE; id = search.nodes[id].parent) {
+        search.route.push_back(id);
+    }
+    std::reverse(search.route.begin(), search.route.end());
+
+    TilePos current = start;
+    out_path.push_back(current);
+    auto walk = [&](const u8* steps, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            current = current + ALL_DIRECTIONS[steps[i]];
+            out_path.push_back(current);
+        }
+    };
+
+    // Start to the first entrance (or straight to the goal inside one chunk)
+    search.steps.clear();
+    if (search.route.empty()) {
+        local_->path_to(goal_local, search.steps);
+        walk(search.steps.data(), search.steps.size());
+        return true;
+    }
+    u32 first_id = search.route.front();
+    local_->path_to(clusters_[start_cluster].nodes[first_id % MAX_CLUSTER_NODES], search.steps);
+    walk(search.steps.data(), search.steps.size());
+
+    // Stored in-chunk paths and border crossings
+    for (size_t i = 0; i + 1 < search.route.size(); ++i) {
+        u32 from = search.route[i];
+        u32 to = search.route[i + 1];
+        u32 cluster = from / MAX_CLUSTER_NODES;
+        if (cluster != to / MAX_CLUSTER_NODES) {
+            u8 dir = direction_index(node_pos(to) - node_pos(from));
+            walk(&dir, 1);
+            continue;
+        }
+
+        const Cluster& c = clusters_[cluster];
+        u32 node = from % MAX_CLUSTER_NODES;
+        for (u32 e = c.edge_begin[node]; e < c.edge_begin[node + 1]; ++e) {
+            if (c.edges[e].to == to % MAX_CLUSTER_NODES) {
+                walk(c.steps.data() + c.edges[e].path_offset, c.edges[e].path_length);
+                break;
+            }
+        }
+    }
+
+    // Last entrance to the goal: follow the goal-side search back to its source
+    u8 cell = clusters_[goal_cluster].nodes[search.route.back() % MAX_CLUSTER_NODES];
+    while (goal_local_->arrived_by[cell] != NO_DIRECTION) {
+        TilePos step = ALL_DIRECTIONS[goal_local_->arrived_by[cell]];
+        current = current - step;
+        out_path.push_back(current);
+        cell = local_index(local_x(cell) - step.x, local_y(cell) - step.y);
+    }
+    return true;
+}
+
+} // namespace city
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "tilemap.hpp"
+#include <memory>
+#include <vector>
+
+namespace city {
+
+// Hierarchical pathfinding (HPA*) with one cluster per chunk.
+//
+// Where two neighbouring chunks share an open stretch of border, an entrance is placed
+// (one tile pair for short openings, one at each end for long ones). Entrance tiles are
+// the nodes of an abstract graph, joined by a step across the border and by precomputed
+// shortest paths inside each chunk. A query connects start and goal to the nodes of their
+// chunks, searches the small abstract graph, and expands the stored in-chunk paths, so
+// long paths cost a handful of node expansions instead of a full-grid search. Paths are
+// near-optimal rather than optimal. Movement rules match Pathfinder (8 directions, no
+// corner cutting).
+//
+// The graph follows TileMap::mask_version: update() rebuilds only chunks whose planes
+// changed since the last sync, plus the neighbours whose shared entrances moved. Not
+// thread-safe; one instance per thread if queried concurrently.
+class HierarchicalPathfinder {
+public:
+    explicit HierarchicalPathfinder(const TileMap& map);
+    ~HierarchicalPathfinder();
+
+    HierarchicalPathfinder(const HierarchicalPathfinder&) = delete;
+    HierarchicalPathfinder& operator=(const HierarchicalPathfinder&) = delete;
+
+    // Bring the graph up to date with the map (find_path calls this)
+    void update();
+
+    // Find a path from start to goal. On success out_path holds every tile from start to
+    // goal inclusive and true is returned; otherwise out_path is left empty.
+    bool find_path(TilePos start, TilePos goal, std::vector<TilePos>& out_path);
+
+    // Abstract graph size (entrance nodes, directed in-chunk edges)
+    size_t node_count() const;
+    size_t edge_count() const;
+
+    // Chunks whose in-chunk edges were recomputed by the last update()
+    u32 last_rebuilt_clusters() const { return last_rebuilt_; }
+
+    // Abstract nodes expanded by the last find_path
+    u32 last_expanded() const { return last_expanded_; }
+
+private:
+    struct Cluster;
+    struct LocalSearch;
+    struct AbstractSearch;
+
+    void rebuild_all(Recti area);
+
+    // Recompute a cluster's Solid rows from the map; returns true if they changed
+    bool refresh_blocked(u32 cluster);
+
+    // Recompute the entrances on the east/south border of a cluster; returns true if
+    // they changed (the border is owned by the cluster to its west/north)
+    bool refresh_east_border(u32 cluster);
+    bool refresh_south_border(u32 cluster);
+
+    // Rebuild a cluster's node list and in-chunk edges from its four borders
+    void rebuild_cluster(u32 cluster);
+
+    // Node id for a local tile of a cluster, or INVALID_NODE
+    u32 find_node(u32 cluster, u8 local) const;
+
+    TilePos cluster_origin(u32 cluster) const;
+
+    const TileMap& map_;
+    Recti area_;
+    i32 clusters_x_{0};
+    i32 clusters_y_{0};
+    bool built_{false};
+    u32 synced_version_{0};
+    u32 last_rebuilt_{0};
+    u32 last_expanded_{0};
+
+    std::vector<Cluster> clusters_;
+    std::unique_ptr<LocalSearch> local_;
+    std::unique_ptr<LocalSearch> goal_local_;
+    std::unique_ptr<AbstractSearch> search_;
+    std::vector<u32> changed_;
+    std::vector<u32> dirty_;
+};
+
+} // namespace city
@@ -0,0 +1,471 @@
+#include "pathfinder.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <limits>
+
+namespace city {
+
+namespace {
+
+constexpr u32 STRAIGHT_COST = 10;
+constexpr u32 DIAGONAL_COST = 14;
+constexpr u32 INFINITE_COST = std::numeric_limits<u32>::max();
+
+i32 sign(i32 v) { return (v > 0) - (v < 0); }
+
+// Cost of the cheapest unobstructed path between two tiles
+u32 octile_distance(TilePos a, TilePos b) {
+    auto dx = static_cast<u32>(std::abs(a.x - b.x));
+    auto dy = static_cast<u32>(std::abs(a.y - b.y));
+    return STRAIGHT_COST * std::max(dx, dy) + (DIAGONAL_COST - STRAIGHT_COST) * std::min(dx, dy);
+}
+
+u32 manhattan_cost(TilePos a, TilePos b) {
+    return STRAIGHT_COST * static_cast<u32>(a.manhattan_distance(b));
+}
+
+// Transpose a 64x64 bit matrix in place (bit c of block[r] <-> bit r of block[c])
+void transpose64(std::array<u64, 64>& block) {
+    u64 mask = 0x00000000FFFFFFFFull;
+    for (size_t width = 32; width != 0; width >>= 1, mask ^= mask << width) {
+        for (size_t k = 0; k < 64; k = ((k | width) + 1) & ~width) {
+            u64 t = ((block[k] >> width) ^ block[k | width]) & mask;
+            block[k] ^= t << width;
+            block[k | width] ^= t;
+        }
+    }
+}
+
+// Walk one line of a blocked-bit grid from pos in direction dir (+1/-1) and return the first
+// position that ends a straight JPS jump: goal_pos, or a free tile whose neighbour on an
+// adjacent line is free while the tile behind that neighbour is blocked (a forced neighbour).
+// Returns -1 if a blocked tile comes first. The grid border must be blocked.
+i32 scan_line(const u64* line, const u64* before, const u64* after, size_t words, i32 pos,
+              i32 dir, i32 goal_pos) {
+    auto word = static_cast<size_t>(pos >> 6);
+    auto goal_word = goal_pos >= 0 ? static_cast<size_t>(goal_pos >> 6) : words;
+    u64 goal_bit = goal_pos >= 0 ? u64{1} << (goal_pos & 63) : 0;
+
+    if (dir > 0) {
+        u64 range = ~u64{0} << (pos & 63);
+        for (;; ++word, range = ~u64{0}) {
+            // Bit p of *_behind = blocked(p - 1)
+            u64 before_behind = (before[word] << 1) | (word > 0 ? before[word - 1] >> 63 : 1);
+            u64 after_behind = (after[word] << 1) | (word > 0 ? after[word - 1] >> 63 : 1);
+            u64 forced = (~before[word] & before_behind) | (~after[word] & after_behind);
+            u64 stop = (line[word] | forced | (word == goal_word ? goal_bit : 0)) & range;
+            if (stop != 0) {
+                auto bit = std::countr_zero(stop);
+                if ((line[word] >> bit) & 1) return -1;
+                return static_cast<i32>(word * 64) + bit;
+            }
+        }
+    }
+
+    u64 range = ~u64{0} >> (63 - (pos & 63));
+    for (;; --word, range = ~u64{0}) {
+        // Bit p of *_behind = blocked(p + 1)
+        u64 before_behind = (before[word] >> 1) |
+                            ((word + 1 < words ? before[word + 1] & 1 : 1) << 63);
+        u64 after_behind = (after[word] >> 1) |
+                           ((word + 1 < words ? after[word + 1] & 1 : 1) << 63);
+        u64 forced = (~before[word] & before_behind) | (~after[word] & after_behind);
+        u64 stop = (line[word] | forced | (word == goal_word ? goal_bit : 0)) & range;
+        if (stop != 0) {
+            auto bit = 63 - std::countl_zero(stop);
+            if ((line[word] >> bit) & 1) return -1;
+            return static_cast<i32>(word * 64) + bit;
+        }
+    }
+}
+
+} // namespace
+
+// Solid bits of the search area plus a one-tile blocked border, stored both row-major and
+// column-major so straight scans in any direction walk whole words.
+// Padded coordinates: px = x - area.x + 1, py = y - area.y + 1.
+struct Pathfinder::BlockedGrid {
+    void rebuild(const TileMap& map, Recti new_area);
+
+    bool blocked(i32 px, i32 py) const {
+        u64 word = rows[static_cast<size_t>(py) * row_words + static_cast<size_t>(px >> 6)];
+        return (word >> (px & 63)) & 1;
+    }
+
+    const u64* row(i32 py) const { return rows.data() + static_cast<size_t>(py) * row_words; }
+    const u64* column(i32 px) const {
+        return columns.data() + static_cast<size_t>(px) * column_words;
+    }
+
+    Recti area;
+    u32 version{0};
+    bool built{false};
+    size_t row_words{0};        // Words per padded row
+    size_t column_words{0};     // Words per padded column
+    std::vector<u64> rows;
+    std::vector<u64> columns;
+};
+
+void Pathfinder::BlockedGrid::rebuild(const TileMap& map, Recti new_area) {
+    area = new_area;
+    version = map.mask_version();
+    built = true;
+
+    auto padded_width = static_cast<size_t>(area.width) + 2;
+    auto padded_height = static_cast<size_t>(area.height) + 2;
+    row_words = (padded_width + 63) / 64;
+    column_words = (padded_height + 63) / 64;
+
+    // Rows straight from the chunk planes; everything outside the area is missing, hence solid
+    rows.resize(padded_height * row_words);
+    for (size_t py = 0; py < padded_height; ++py) {
+        i32 y = area.y + static_cast<i32>(py) - 1;
+        for (size_t word = 0; word < row_words; ++word) {
+            i32 x = area.x + static_cast<i32>(word * 64) - 1;
+            rows[py * row_words + word] = map.row_mask(TilePlane::Solid, {x, y}, 64);
+        }
+    }
+
+    // Columns by transposing 64x64 blocks; rows past the padded height read as blocked
+    columns.resize(row_words * 64 * column_words);
+    std::array<u64, 64> block;
+    for (size_t block_y = 0; block_y < column_words; ++block_y) {
+        for (size_t word = 0; word < row_words; ++word) {
+            for (size_t i = 0; i < 64; ++i) {
+                size_t py = block_y * 64 + i;
+                block[i] = py < padded_height ? rows[py * row_words + word] : ~u64{0};
+            }
+            transpose64(block);
+            for (size_t i = 0; i < 64; ++i) {
+                columns[(word * 64 + i) * column_words + block_y] = block[i];
+            }
+        }
+    }
+}
+
+// Per-thread search state. Nodes are stamped with the search they were last touched by,
+// so starting a new search is O(1) instead of clearing the whole grid.
+struct Pathfinder::SearchScratch {
+    struct Node {
+        u32 stamp{0};
+        u32 g{INFINITE_COST};
+        u32 parent{0};
+        bool closed{false};
+    };
+
+    struct OpenEntry {
+        u32 f;
+        u32 g;
+        u32 index;
+    };
+
+    // Heap order: min-heap on f; on ties prefer the deeper node (higher g)
+    static bool open_after(const OpenEntry& a, const OpenEntry& b) {
+        return a.f > b.f || (a.f == b.f && a.g < b.g);
+    }
+
+    bool run(const BlockedGrid& blocked_grid, TilePos start, TilePos target,
+             const PathOptions& options, std::vector<TilePos>& out_path);
+
+    // Positions are padded grid coordinates from here on
+    bool passable(i32 px, i32 py) const { return !grid->blocked(px, py); }
+
+    u32 index_of(TilePos pos) const {
+        return static_cast<u32>(pos.y - 1) * static_cast<u32>(grid->area.width) +
+               static_cast<u32>(pos.x - 1);
+    }
+
+    TilePos pos_of(u32 index) const {
+        auto width = static_cast<u32>(grid->area.width);
+        return {static_cast<i32>(index % width) + 1, static_cast<i32>(index / width) + 1};
+    }
+
+    u32 heuristic(TilePos pos) const {
+        return diagonal ? octile_distance(pos, goal) : manhattan_cost(pos, goal);
+    }
+
+    // Lower a node's cost and queue it if the new cost is better
+    void relax(TilePos pos, u32 g, u32 parent);
+
+    // Queue the neighbours of a node: every legal step for A*, jump points for JPS
+    void expand_astar(TilePos pos, u32 index, u32 g);
+    void expand_jump_point(TilePos pos, u32 index, u32 g);
+
+    // Walk from (x, y) in direction (dx, dy) until reaching a jump point (the goal, or a tile
+    // with a forced neighbour). Returns false if the walk hits an obstacle first.
+    bool jump(i32 x, i32 y, i32 dx, i32 dy, TilePos& out) const;
+
+    // Straight jumps along a row / column (see scan_line); -1 if blocked
+    i32 scan_row(i32 px, i32 py, i32 dx) const {
+        return scan_line(grid->row(py), grid->row(py - 1), grid->row(py + 1), grid->row_words,
+                         px, dx, py == goal.y ? goal.x : -1);
+    }
+
+    i32 scan_column(i32 px, i32 py, i32 dy) const {
+        return scan_line(grid->column(px), grid->column(px - 1), grid->column(px + 1),
+                         grid->column_words, py, dy, px == goal.x ? goal.y : -1);
+    }
+
+    // Follow parents back from the goal and fill in the tiles between jump points
+    void reconstruct(u32 goal_index, std::vector<TilePos>& out_path);
+
+    std::vector<Node> nodes;
+    std::vector<OpenEntry> open;
+    std::vector<TilePos> waypoints;
+    u32 stamp{0};
+    u32 expanded{0};
+
+    // Current search
+    const BlockedGrid* grid{nullptr};
+    TilePos goal;
+    bool diagonal{true};
+};
+
+bool Pathfinder::SearchScratch::run(const BlockedGrid& blocked_grid, TilePos start,
+                                    TilePos target, const PathOptions& options,
+                                    std::vector<TilePos>& out_path) {
+    out_path.clear();
+    expanded = 0;
+
+    grid = &blocked_grid;
+    const Recti& area = grid->area;
+    if (!area.contains(Vec2i{start.x, start.y}) || !area.contains(Vec2i{target.x, target.y})) {
+        return false;
+    }
+
+    TilePos offset{area.x - 1, area.y - 1};
+    TilePos from = start - offset;
+    goal = target - offset;
+    diagonal = options.allow_diagonal;
+    bool use_jps = options.algorithm == PathAlgorithm::JumpPoint && diagonal;
+
+    if (!passable(from.x, from.y) || !passable(goal.x, goal.y)) return false;
+
+    size_t area_size = static_cast<size_t>(area.width) * static_cast<size_t>(area.height);
+    if (nodes.size() < area_size) {
+        nodes.resize(area_size);
+    }
+    if (++stamp == 0) {
+        for (auto& node : nodes) node.stamp = 0;
+        stamp = 1;
+    }
+    open.clear();
+
+    u32 goal_index = index_of(goal);
+    relax(from, 0, index_of(from));
+
+    while (!open.empty()) {
+        std::pop_heap(open.begin(), open.end(), open_after);
+        OpenEntry entry = open.back();
+        open.pop_back();
+
+        Node& node = nodes[entry.index];
+        if (node.closed || entry.g != node.g) continue;    // Stale entry
+        node.closed = true;
+        ++expanded;
+
+        if (entry.index == goal_index) {
+            reconstruct(goal_index, out_path);
+            for (TilePos& pos : out_path) pos = pos + offset;
+            return true;
+        }
+        if (options.max_expanded != 0 && expanded >= options.max_expanded) break;
+
+        TilePos pos = pos_of(entry.index);
+        if (use_jps) {
+            expand_jump_point(pos, entry.index, entry.g);
+        } else {
+            expand_astar(pos, entry.index, entry.g);
+        }
+    }
+    return false;
+}
+
+void Pathfinder::SearchScratch::relax(TilePos pos, u32 g, u32 parent) {
+    u32 index = index_of(pos);
+    Node& node = nodes[index];
+    if (node.stamp != stamp) {
+        node = Node{stamp, INFINITE_COST, 0, false};
+    }
+    if (node.closed || g >= node.g) return;
+
+    node.g = g;
+    node.parent = parent;
+    open.push_back({g + heuristic(pos), g, index});
+    std::push_heap(open.begin(), open.end(), open_after);
+}
+
+void Pathfinder::SearchScratch::expand_astar(TilePos pos, u32 index, u32 g) {
+    const TilePos* directions = diagonal ? ALL_DIRECTIONS : CARDINAL_DIRECTIONS;
+    size_t count = diagonal ? 8 : 4;
+
+    for (size_t i = 0; i < count; ++i) {
+        TilePos dir = directions[i];
+        if (!passable(pos.x + dir.x, pos.y + dir.y)) continue;
+
+        bool is_diagonal = dir.x != 0 && dir.y != 0;
+        if (is_diagonal && (!passable(pos.x + dir.x, pos.y) || !passable(pos.x, pos.y + dir.y))) {
+            continue;   // Can't cut through corners
+        }
+        relax(pos + dir, g + (is_diagonal ? DIAGONAL_COST : STRAIGHT_COST), index);
+    }
+}
+
+void Pathfinder::SearchScratch::expand_jump_point(TilePos pos, u32 index, u32 g) {
+    TilePos parent = pos_of(nodes[index].parent);
+    i32 dx = sign(pos.x - parent.x);
+    i32 dy = sign(pos.y - parent.y);
+
+    // Candidate directions: all of them from the start, otherwise the natural and forced
+    // neighbours of the direction we arrived from
+    TilePos candidates[8];
+    size_t count = 0;
+    if (dx == 0 && dy == 0) {
+        for (TilePos dir : ALL_DIRECTIONS) candidates[count++] = dir;
+    } else if (dx != 0 && dy != 0) {
+        candidates[count++] = {0, dy};
+        candidates[count++] = {dx, 0};
+        candidates[count++] = {dx, dy};
+    } else if (dx != 0) {
+        candidates[count++] = {dx, 0};
+        candidates[count++] = {dx, 1};
+        candidates[count++] = {dx, -1};
+        candidates[count++] = {0, 1};
+        candidates[count++] = {0, -1};
+    } else {
+        candidates[count++] = {0, dy};
+        candidates[count++] = {1, dy};
+        candidates[count++] = {-1, dy};
+        candidates[count++] = {1, 0};
+        candidates[count++] = {-1, 0};
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        TilePos dir = candidates[i];
+        if (dir.x != 0 && dir.y != 0 &&
+            (!passable(pos.x + dir.x, pos.y) || !passable(pos.x, pos.y + dir.y))) {
+            continue;   // Can't cut through corners
+        }
+
+        TilePos jump_point;
+        if (jump(pos.x + dir.x, pos.y + dir.y, dir.x, dir.y, jump_point)) {
+            relax(jump_point, g + octile_distance(pos, jump_point), index);
+        }
+    }
+}
+
+bool Pathfinder::SearchScratch::jump(i32 x, i32 y, i32 dx, i32 dy, TilePos& out) const {
+    if (dy == 0) {
+        i32 stop = scan_row(x, y, dx);
+        out = {stop, y};
+        return stop >= 0;
+    }
+    if (dx == 0) {
+        i32 stop = scan_column(x, y, dy);
+        out = {x, stop};
+        return stop >= 0;
+    }
+
+    while (true) {
+        if (!passable(x, y)) return false;
+        if (x == goal.x && y == goal.y) {
+            out = goal;
+            return true;
+        }
+
+        // A diagonal stops wherever one of its straight components finds something
+        if (scan_row(x + dx, y, dx) >= 0 || scan_column(x, y + dy, dy) >= 0) {
+            out = {x, y};
+            return true;
+        }
+        if (!passable(x + dx, y) || !passable(x, y + dy)) return false;
+
+        x += dx;
+        y += dy;
+    }
+}
+
+void Pathfinder::SearchScratch::reconstruct(u32 goal_index, std::vector<TilePos>& out_path) {
+    waypoints.clear();
+    for (u32 index = goal_index;; index = nodes[index].parent) {
+        waypoints.push_back(pos_of(index));
+        if (nodes[index].parent == index) break;
+    }
+
+    out_path.push_back(waypoints.back());
+    for (size_t i = waypoints.size() - 1; i > 0; --i) {
+        TilePos current = waypoints[i];
+        TilePos next = waypoints[i - 1];
+        TilePos step{sign(next.x - current.x), sign(next.y - current.y)};
+        while (current != next) {
+            current = current + step;
+            out_path.push_back(current);
+        }
+    }
+}
+
+Pathfinder::Pathfinder(const TileMap& map)
+    : map_(map), grid_(std::make_unique<BlockedGrid>()) {
+    scratch_.push_back(std::make_unique<SearchScratch>());
+}
+
+Pathfinder::~Pathfinder() = default;
+
+bool Pathfinder::find_path(TilePos start, TilePos goal, std::vector<TilePos>& out_path,
+                           const PathOptions& options) {
+    sync_grid();
+    return scratch_[0]->run(*grid_, start, goal, options, out_path);
+}
+
+void Pathfinder::find_paths(std::span<const PathRequest> requests,
+                            std::span<std::vector<TilePos>> results, const PathOptions& options) {
+    sync_grid();
+    SearchScratch& scratch = *scratch_[0];
+    for (size_t i = 0; i < requests.size(); ++i) {
+        scratch.run(*grid_, requests[i].start, requests[i].goal, options, results[i]);
+    }
+}
+
+void Pathfinder::find_paths(std::span<const PathRequest> requests,
+                            std::span<std::vector<TilePos>> results, JobSystem& jobs,
+                            const PathOptions& options) {
+    sync_grid();
+
+    // Create every thread's scratch up front; the workers only index into scratch_. The
+    // index is the thread's place in this pool (0 for the caller, whatever pool owns it)
+    while (scratch_.size() < jobs.thread_count()) {
+        scratch_.push_back(std::make_unique<SearchScratch>());
+    }
+
+    jobs.parallel_for(requests.size(), 4, [&](size_t begin, size_t end) {
+        SearchScratch& scratch = *scratch_[jobs.thread_index()];
+        for (size_t i = begin; i < end; ++i) {
+            scratch.run(*grid_, requests[i].start, requests[i].goal, options, results[i]);
+        }
+    });
+}
+
+u32 Pathfinder::last_expanded() const {
+    return scratch_[0]->expanded;
+}
+
+void Pathfinder::sync_grid() {
+    // Everything that can move the search area (new chunks, set_bounds, deserialize, clear)
+    // bumps the mask version, so a warm grid skips the O(chunks) loaded_area() walk
+    if (grid_->built && grid_->version == map_.mask_version() &&
+        synced_chunks_ == map_.chunk_count()) {
+        return;
+    }
+    synced_chunks_ = map_.chunk_count();
+
+    Recti area = map_.has_bounds() ? Recti{0, 0, map_.width(), map_.height()}
+                                   : map_.loaded_area();
+    bool same_area = area.x == grid_->area.x && area.y == grid_->area.y &&
+                     area.width == grid_->area.width && area.height == grid_->area.height;
+    if (!grid_->built || !same_area || grid_->version != map_.mask_version()) {
+        grid_->rebuild(map_, area);
+    }
+}
+
+} // namespace city
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "tilemap.hpp"
+#include "core/util/job_system.hpp"
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace city {
+
+enum class PathAlgorithm : u8 {
+    AStar,
+    JumpPoint,      // Jump Point Search; 8-directional only (4-directional requests use A*)
+};
+
+struct PathOptions {
+    PathAlgorithm algorithm{PathAlgorithm::JumpPoint};
+    bool allow_diagonal{true};
+    u32 max_expanded{0};        // Give up after expanding this many nodes (0 = no limit)
+};
+
+struct PathRequest {
+    TilePos start;
+    TilePos goal;
+};
+
+// Grid pathfinding over TileMap passability.
+// Moves follow the same rules as TileMap::get_passable_neighbors: cardinal steps cost 10,
+// diagonal steps cost 14 and may not cut corners (both side tiles must be passable).
+//
+// The search area is the map bounds, or the area covered by loaded chunks for unbounded maps.
+// Passability is read from a bit grid of the area (row- and column-major, built from the
+// chunk Solid planes and rebuilt when TileMap::mask_version changes), which lets JPS scan
+// 64 tiles per step. Node state and the open list live in scratch buffers sized to the area
+// and reused across searches (stamped per search instead of cleared), so queries don't
+// allocate once warm. The map must not change while a search is running, and searches on
+// one Pathfinder must not be started from several threads at once (use the batch calls).
+class Pathfinder {
+public:
+    explicit Pathfinder(const TileMap& map);
+    ~Pathfinder();
+
+    Pathfinder(const Pathfinder&) = delete;
+    Pathfinder& operator=(const Pathfinder&) = delete;
+
+    // Find a path from start to goal. On success out_path holds every tile from start to
+    // goal inclusive and true is returned; otherwise out_path is left empty.
+    bool find_path(TilePos start, TilePos goal, std::vector<TilePos>& out_path,
+                   const PathOptions& options = {});
+
+    // Solve a batch of requests; results[i] receives the path for requests[i] (empty if none).
+    // results must be at least as long as requests.
+    void find_paths(std::span<const PathRequest> requests,
+                    std::span<std::vector<TilePos>> results, const PathOptions& options = {});
+
+    // Parallel batch: requests are spread across the job system, one scratch buffer per pool
+    // thread. May be called from a worker of another JobSystem
+    void find_paths(std::span<const PathRequest> requests,
+                    std::span<std::vector<TilePos>> results, JobSystem& jobs,
+                    const PathOptions& options = {});
+
+    // Nodes expanded by the last search of find_path or the sequential find_paths (for profiling)
+    u32 last_expanded() const;
+
+private:
+    struct BlockedGrid;
+    struct SearchScratch;
+
+    // Rebuild the bit grid if the map's masks or search area changed
+    void sync_grid();
+
+    const TileMap& map_;
+    std::unique_ptr<BlockedGrid> grid_;
+    size_t synced_chunks_{0};   // Map chunk count at the last sync_grid
+    // [0] serves the sequential calls and the batch caller; batches index by
+    // JobSystem::thread_index
+    std::vector<std::unique_ptr<SearchScratch>> scratch_;
+};
+
+} // namespace city
@@ -2,6 +2,7 @@
 
 #include "core/util/types.hpp"
 #include "core/net/serialization.hpp"
+#include <array>
 #include <functional>
 
 namespace city {
@@ -39,6 +40,8 @@ struct Tile {
     bool is_opaque() const { return has_flag(flags, TileFlags::Opaque); }
     bool has_wall() const { return wall_id != 0; }
 
+    bool operator==(const Tile&) const = default;
+
     void serialize(Serializer& s) const {
         s.write_u16(floor_id);
         s.write_u16(wall_id);
@@ -128,6 +131,25 @@ constexpr TilePos ALL_DIRECTIONS[] = {
     DIRECTION_SOUTH, DIRECTION_SW, DIRECTION_WEST, DIRECTION_NW
 };
 
+// Moves allowed from a tile given which tiles of its 3x3 neighbourhood are open (bit
+// (dy + 1) * 3 + dx + 1), as a mask of ALL_DIRECTIONS indices. Diagonals need both side
+// tiles open, as in TileMap::get_passable_neighbors.
+constexpr std::array<u8, 512> ALLOWED_MOVES = [] {
+    std::array<u8, 512> table{};
+    for (u32 open = 0; open < table.size(); ++open) {
+        auto is_open = [open](i32 dx, i32 dy) { return (open >> ((dy + 1) * 3 + dx + 1)) & 1; };
+        for (u32 dir = 0; dir < 8; ++dir) {
+            TilePos step = ALL_DIRECTIONS[dir];
+            bool allowed = is_open(step.x, step.y);
+            if (step.x != 0 && step.y != 0) {
+                allowed = allowed && is_open(step.x, 0) && is_open(0, step.y);
+            }
+            if (allowed) table[open] = static_cast<u8>(table[open] | (1u << dir));
+        }
+    }
+    return table;
+}();
+
 } // namespace city
 
 // Hash support for TilePos
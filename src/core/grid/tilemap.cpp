@@ -1,11 +1,15 @@
 #include "tilemap.hpp"
+#include <algorithm>
 #include <cmath>
+#include <utility>
 
 namespace city {
 
 void TileMap::set_bounds(i32 width, i32 height) {
     width_ = width;
     height_ = height;
+    rebuild_chunk_grid();
+    ++mask_version_;
 }
 
 bool TileMap::in_bounds(TilePos pos) const {
@@ -13,19 +17,7 @@ bool TileMap::in_bounds(TilePos pos) const {
     return pos.x >= 0 && pos.x < width_ && pos.y >= 0 && pos.y < height_;
 }
 
-Tile* TileMap::get_tile(TilePos pos) {
-    if (!in_bounds(pos)) return nullptr;
-
-    TilePos chunk_origin = Chunk::get_chunk_origin(pos);
-    auto* chunk = get_chunk(chunk_origin);
-    if (!chunk) return nullptr;
-
-    return chunk->at_world(pos);
-}
-
-const Tile* TileMap::get_tile(TilePos pos) const {
-    if (!in_bounds(pos)) return nullptr;
-
+const Tile* TileMap::find_tile(TilePos pos) const {
     TilePos chunk_origin = Chunk::get_chunk_origin(pos);
     auto* chunk = get_chunk(chunk_origin);
     if (!chunk) return nullptr;
@@ -37,20 +29,43 @@ void TileMap::set_tile(TilePos pos, Tile tile) {
     if (!in_bounds(pos)) return;
 
     TilePos chunk_origin = Chunk::get_chunk_origin(pos);
-    auto& chunk = get_or_create_chunk(chunk_origin);
+    auto& chunk = chunk_for_write(chunk_origin);
 
     TilePos local = Chunk::world_to_local(pos);
-    chunk.at(local.x, local.y) = tile;
+    u32 version = chunk.version();
+    if (chunk.set(local.x, local.y, tile)) {
+        chunk.set_mask_version(++mask_version_);
+    }
+    if (chunk.version() != version) mark_dirty(chunk);
 }
 
-bool TileMap::is_passable(TilePos pos) const {
-    const Tile* tile = get_tile(pos);
-    return tile && tile->is_passable();
+void TileMap::fill_chunk(TilePos chunk_origin, Tile tile) {
+    if (Chunk::get_chunk_origin(chunk_origin) != chunk_origin || !in_bounds(chunk_origin)) return;
+
+    Chunk& chunk = chunk_for_write(chunk_origin);
+    chunk.fill(tile);
+    chunk.set_mask_version(++mask_version_);
+    mark_dirty(chunk);
+}
+
+void TileMap::drain_dirty_chunks(std::vector<TilePos>& out) {
+    out.clear();
+    out.swap(dirty_chunks_);
+    std::sort(out.begin(), out.end(), [](TilePos a, TilePos b) {
+        return a.y != b.y ? a.y < b.y : a.x < b.x;
+    });
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    for (TilePos origin : out) {
+        auto it = chunks_.find(origin);
+        if (it != chunks_.end()) it->second->set_dirty(false);
+    }
 }
 
-bool TileMap::is_opaque(TilePos pos) const {
-    const Tile* tile = get_tile(pos);
-    return tile && tile->is_opaque();
+void TileMap::mark_dirty(Chunk& chunk) {
+    chunk.set_version(++content_version_);
+    if (chunk.is_dirty()) return;
+    chunk.set_dirty(true);
+    dirty_chunks_.push_back(chunk.origin());
 }
 
 std::vector<TilePos> TileMap::get_passable_neighbors(TilePos pos, bool allow_diagonal) const {
@@ -78,9 +93,75 @@ std::vector<TilePos> TileMap::get_passable_neighbors(TilePos pos, bool allow_dia
     return neighbors;
 }
 
-Chunk* TileMap::get_chunk(TilePos chunk_origin) {
-    auto it = chunks_.find(chunk_origin);
-    return it != chunks_.end() ? it->second.get() : nullptr;
+namespace {
+
+// Bits [begin, end) of a u64, 0 <= begin <= end <= 64
+u64 bit_range(i64 begin, i64 end) {
+    if (begin >= end) return 0;
+    u64 below_end = end >= 64 ? ~u64{0} : (u64{1} << end) - 1;
+    return below_end & ~((u64{1} << begin) - 1);
+}
+
+} // namespace
+
+u64 TileMap::row_mask(TilePlane plane, TilePos start, i32 count) const {
+    const bool missing_set = plane == TilePlane::Solid;
+    const i32 local_y = start.y & CHUNK_MASK;
+
+    u64 result = 0;
+    for (i32 offset = 0; offset < count;) {
+        i32 x = start.x + offset;
+        i32 local_x = x & CHUNK_MASK;
+        i32 span = std::min(CHUNK_SIZE - local_x, count - offset);
+        u64 span_bits = (u64{1} << span) - 1;
+
+        u64 bits = missing_set ? span_bits : 0;
+        if (const Chunk* chunk = chunk_at({x, start.y})) {
+            bits = (u64{chunk->row_mask(plane, local_y)} >> local_x) & span_bits;
+        }
+        result |= bits << offset;
+        offset += span;
+    }
+
+    if (has_bounds()) {
+        // Chunks on the right/top edge extend past the bounds; those tiles don't exist
+        u64 valid = 0;
+        if (start.y >= 0 && start.y < height_) {
+            valid = bit_range(std::max<i64>(0, -i64{start.x}),
+                              std::min<i64>(count, i64{width_} - start.x));
+        }
+        u64 missing = bit_range(0, count) & ~valid;
+        result = (result & valid) | (missing_set ? missing : 0);
+    }
+    return result;
+}
+
+void TileMap::rect_mask(TilePlane plane, Recti rect, std::vector<u64>& rows) const {
+    rows.resize(static_cast<size_t>(std::max(rect.height, 0)));
+    for (i32 r = 0; r < rect.height; ++r) {
+        rows[static_cast<size_t>(r)] = row_mask(plane, {rect.x, rect.y + r}, rect.width);
+    }
+}
+
+bool TileMap::any_in_rect(TilePlane plane, Recti rect) const {
+    for (i32 y = rect.y; y < rect.bottom(); ++y) {
+        for (i32 x = rect.x; x < rect.right(); x += 64) {
+            if (row_mask(plane, {x, y}, std::min(64, rect.right() - x)) != 0) return true;
+        }
+    }
+    return false;
+}
+
+const Chunk* TileMap::chunk_at(TilePos pos) const {
+    if (!has_bounds()) {
+        return get_chunk({pos.x & ~CHUNK_MASK, pos.y & ~CHUNK_MASK});
+    }
+    i32 chunk_x = pos.x >> CHUNK_SHIFT;
+    i32 chunk_y = pos.y >> CHUNK_SHIFT;
+    if (chunk_x < 0 || chunk_y < 0 || chunk_x >= grid_width_ || chunk_y >= grid_height_) {
+        return nullptr;
+    }
+    return chunk_grid_[grid_index(chunk_x, chunk_y)];
 }
 
 const Chunk* TileMap::get_chunk(TilePos chunk_origin) const {
@@ -88,7 +169,11 @@ const Chunk* TileMap::get_chunk(TilePos chunk_origin) const {
     return it != chunks_.end() ? it->second.get() : nullptr;
 }
 
-Chunk& TileMap::get_or_create_chunk(TilePos chunk_origin) {
+const Chunk& TileMap::get_or_create_chunk(TilePos chunk_origin) {
+    return chunk_for_write(chunk_origin);
+}
+
+Chunk& TileMap::chunk_for_write(TilePos chunk_origin) {
     auto it = chunks_.find(chunk_origin);
     if (it != chunks_.end()) {
         return *it->second;
@@ -97,6 +182,11 @@ Chunk& TileMap::get_or_create_chunk(TilePos chunk_origin) {
     auto chunk = std::make_unique<Chunk>(chunk_origin);
     auto& ref = *chunk;
     chunks_[chunk_origin] = std::move(chunk);
+    if (auto* slot = grid_slot(chunk_origin)) {
+        *slot = &ref;
+    }
+    ref.set_mask_version(++mask_version_);
+    mark_dirty(ref);
     return ref;
 }
 
@@ -113,40 +203,44 @@ std::vector<TilePos> TileMap::get_chunk_origins() const {
     return origins;
 }
 
-bool TileMap::has_line_of_sight(TilePos from, TilePos to) const {
-    auto line = get_line(from, to);
-    for (const auto& pos : line) {
-        if (pos == from || pos == to) continue;
-        if (is_opaque(pos)) return false;
+Recti TileMap::loaded_area() const {
+    if (chunks_.empty()) return {};
+
+    TilePos min_origin = chunks_.begin()->first;
+    TilePos max_origin = min_origin;
+    for (const auto& [origin, _] : chunks_) {
+        min_origin = {std::min(min_origin.x, origin.x), std::min(min_origin.y, origin.y)};
+        max_origin = {std::max(max_origin.x, origin.x), std::max(max_origin.y, origin.y)};
     }
-    return true;
+    return {min_origin.x, min_origin.y,
+            max_origin.x - min_origin.x + CHUNK_SIZE, max_origin.y - min_origin.y + CHUNK_SIZE};
 }
 
-std::vector<TilePos> TileMap::get_line(TilePos from, TilePos to) {
-    std::vector<TilePos> line;
-
-    i32 dx = std::abs(to.x - from.x);
-    i32 dy = std::abs(to.y - from.y);
-    i32 sx = from.x < to.x ? 1 : -1;
-    i32 sy = from.y < to.y ? 1 : -1;
-    i32 err = dx - dy;
-
-    TilePos current = from;
-    while (true) {
-        line.push_back(current);
-        if (current == to) break;
-
-        i32 e2 = 2 * err;
-        if (e2 > -dy) {
-            err -= dy;
-            current.x += sx;
-        }
-        if (e2 < dx) {
-            err += dx;
-            current.y += sy;
+bool TileMap::has_line_of_sight(TilePos from, TilePos to) const {
+    const Chunk* chunk = nullptr;
+    TilePos chunk_origin{0, 0};
+    bool have_chunk = false;
+    return walk_line(from, to, [&](TilePos pos) {
+        if (pos == from || pos == to) return true;
+
+        TilePos origin{pos.x & ~CHUNK_MASK, pos.y & ~CHUNK_MASK};
+        if (!have_chunk || origin != chunk_origin) {
+            chunk = chunk_at(pos);
+            chunk_origin = origin;
+            have_chunk = true;
         }
-    }
+        if (!chunk) return true;
+        ChunkRowMask row = chunk->row_mask(TilePlane::Opaque, pos.y & CHUNK_MASK);
+        return ((row >> (pos.x & CHUNK_MASK)) & 1) == 0;
+    });
+}
 
+std::vector<TilePos> TileMap::get_line(TilePos from, TilePos to) {
+    std::vector<TilePos> line;
+    walk_line(from, to, [&line](TilePos pos) {
+        line.push_back(pos);
+        return true;
+    });
     return line;
 }
 
@@ -166,11 +260,42 @@ void TileMap::deserialize(Deserializer& d) {
     u32 chunk_count = d.read_u32();
 
     chunks_.clear();
+    ++mask_version_;
     for (u32 i = 0; i < chunk_count; ++i) {
         auto chunk = std::make_unique<Chunk>();
         chunk->deserialize(d);
+        chunk->set_mask_version(mask_version_);
+        mark_dirty(*chunk);
         chunks_[chunk->origin()] = std::move(chunk);
     }
+    rebuild_chunk_grid();
+}
+
+bool TileMap::serialize_chunk(Serializer& s, TilePos chunk_origin) const {
+    const Chunk* chunk = get_chunk(chunk_origin);
+    if (!chunk) return false;
+    s.write_u32(chunk->version());
+    chunk->serialize(s);
+    return true;
+}
+
+bool TileMap::deserialize_chunk(Deserializer& d) {
+    u32 version = d.read_u32();
+    auto chunk = std::make_unique<Chunk>();
+    chunk->deserialize(d);
+
+    TilePos origin = chunk->origin();
+    if (Chunk::get_chunk_origin(origin) != origin || !in_bounds(origin)) return false;
+
+    chunk->set_mask_version(++mask_version_);
+    mark_dirty(*chunk);
+    chunk->set_version(version);
+    content_version_ = std::max(content_version_, version);
+    if (auto* slot = grid_slot(origin)) {
+        *slot = chunk.get();
+    }
+    chunks_[origin] = std::move(chunk);
+    return true;
 }
 
 void TileMap::serialize_region(Serializer& s, Recti region) const {
@@ -196,6 +321,30 @@ void TileMap::serialize_region(Serializer& s, Recti region) const {
 
 void TileMap::clear() {
     chunks_.clear();
+    std::fill(chunk_grid_.begin(), chunk_grid_.end(), nullptr);
+    ++mask_version_;
+}
+
+Chunk** TileMap::grid_slot(TilePos chunk_origin) {
+    if (!has_bounds() || chunk_origin.x < 0 || chunk_origin.y < 0) return nullptr;
+
+    i32 chunk_x = chunk_origin.x >> CHUNK_SHIFT;
+    i32 chunk_y = chunk_origin.y >> CHUNK_SHIFT;
+    if (chunk_x >= grid_width_ || chunk_y >= grid_height_) return nullptr;
+    return &chunk_grid_[grid_index(chunk_x, chunk_y)];
+}
+
+void TileMap::rebuild_chunk_grid() {
+    grid_width_ = has_bounds() ? (width_ + CHUNK_MASK) >> CHUNK_SHIFT : 0;
+    grid_height_ = has_bounds() ? (height_ + CHUNK_MASK) >> CHUNK_SHIFT : 0;
+    chunk_grid_.assign(static_cast<size_t>(grid_width_) * static_cast<size_t>(grid_height_),
+                       nullptr);
+
+    for (const auto& [origin, chunk] : chunks_) {
+        if (auto* slot = grid_slot(origin)) {
+            *slot = chunk.get();
+        }
+    }
 }
 
 } // namespace city
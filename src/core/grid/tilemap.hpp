@@ -1,6 +1,7 @@
 #pragma once
 
 #include "chunk.hpp"
+#include <cstdlib>
 #include <unordered_map>
 #include <memory>
 #include <vector>
@@ -8,7 +9,10 @@
 
 namespace city {
 
-// TileMap manages a collection of chunks
+// TileMap manages a collection of chunks.
+// Chunks are owned by a hash map keyed by origin. Bounded maps (set_bounds) additionally keep
+// a dense grid of chunk pointers indexed by (cx, cy), so tile lookups there are a bounds
+// check, two shifts and an index; unbounded maps go through the hash map.
 class TileMap {
 public:
     TileMap() = default;
@@ -24,30 +28,70 @@ public:
 
     // ========== Tile Access ==========
 
-    // Get tile at position (returns nullptr if chunk doesn't exist)
-    Tile* get_tile(TilePos pos);
-    const Tile* get_tile(TilePos pos) const;
+    // Get tile at position (returns nullptr if chunk doesn't exist).
+    // Read-only so the chunk bitplanes stay in sync; write through set_tile.
+    const Tile* get_tile(TilePos pos) const {
+        if (!has_bounds()) return find_tile(pos);
+        if (static_cast<u32>(pos.x) >= static_cast<u32>(width_) ||
+            static_cast<u32>(pos.y) >= static_cast<u32>(height_)) {
+            return nullptr;
+        }
+        const Chunk* chunk = chunk_grid_[grid_index(pos.x >> CHUNK_SHIFT, pos.y >> CHUNK_SHIFT)];
+        return chunk ? &chunk->at(pos.x & CHUNK_MASK, pos.y & CHUNK_MASK) : nullptr;
+    }
 
     // Set tile at position (creates chunk if needed)
     void set_tile(TilePos pos, Tile tile);
 
     // Check if tile is passable
-    bool is_passable(TilePos pos) const;
+    bool is_passable(TilePos pos) const {
+        const Tile* tile = get_tile(pos);
+        return tile && tile->is_passable();
+    }
 
     // Check if tile blocks line of sight
-    bool is_opaque(TilePos pos) const;
+    bool is_opaque(TilePos pos) const {
+        const Tile* tile = get_tile(pos);
+        return tile && tile->is_opaque();
+    }
 
     // Get passable neighbors (for pathfinding)
     std::vector<TilePos> get_passable_neighbors(TilePos pos, bool allow_diagonal = false) const;
 
+    // ========== Flag Bitmasks ==========
+
+    // Bit i is set if tile (start.x + i, start.y) has the plane's flag. Tiles that don't
+    // exist (no chunk, or outside the bounds) count as set for Solid, matching is_passable,
+    // and as unset for the other planes. count must be 0..64.
+    u64 row_mask(TilePlane plane, TilePos start, i32 count) const;
+
+    // row_mask for every row of rect: rows[r] covers rect.x .. rect.x + rect.width - 1 on row
+    // rect.y + r. rect.width must be at most 64.
+    void rect_mask(TilePlane plane, Recti rect, std::vector<u64>& rows) const;
+
+    // True if any tile in rect has the plane's flag (same missing-tile rules as row_mask)
+    bool any_in_rect(TilePlane plane, Recti rect) const;
+
+    // Bumped whenever a plane mask may have changed through this TileMap (set_tile changing
+    // flags, new chunks, set_bounds, deserialize, clear). Lets derived data such as
+    // pathfinding grids tell when to rebuild. Chunks whose planes changed are stamped with
+    // the new value (Chunk::mask_version), so consumers that remember the version they last
+    // synced to can find the changed chunks. Chunks are only handed out const, so every
+    // write goes through this TileMap and is tracked.
+    u32 mask_version() const { return mask_version_; }
+
     // ========== Chunk Access ==========
 
-    // Get chunk at origin (returns nullptr if doesn't exist)
-    Chunk* get_chunk(TilePos chunk_origin);
+    // Get chunk at origin (returns nullptr if doesn't exist). Read-only: write through
+    // set_tile/fill_chunk.
     const Chunk* get_chunk(TilePos chunk_origin) const;
 
-    // Get or create chunk
-    Chunk& get_or_create_chunk(TilePos chunk_origin);
+    // Get or create chunk (a new chunk is tracked like any other change)
+    const Chunk& get_or_create_chunk(TilePos chunk_origin);
+
+    // Chunk holding a tile position (nullptr if none; bounded maps only see chunks inside the
+    // bounds). Uses the dense chunk grid when the map is bounded.
+    const Chunk* chunk_at(TilePos pos) const;
 
     // Check if chunk exists
     bool has_chunk(TilePos chunk_origin) const;
@@ -55,14 +99,72 @@ public:
     // Get all chunk origins
     std::vector<TilePos> get_chunk_origins() const;
 
+    // Tile area covered by loaded chunks (empty if there are none)
+    Recti loaded_area() const;
+
+    // ========== Change Tracking ==========
+
+    // Fill a whole chunk with one tile (creating it if needed), tracked like set_tile
+    void fill_chunk(TilePos chunk_origin, Tile tile);
+
+    // Chunks created or changed through this TileMap are stamped with the next value of one
+    // map-wide counter (Chunk::version), so versions only go up, even for a chunk recreated
+    // after clear() or deserialize(), and replication can compare them per origin.
+    u32 content_version() const { return content_version_; }
+
+    // Origins of chunks created, or whose tiles changed, through this TileMap since the last
+    // drain: each once, in row-major order. Meant to be drained once per tick by
+    // replication. After clear() an origin may no longer have a chunk.
+    void drain_dirty_chunks(std::vector<TilePos>& out);
+    size_t dirty_chunk_count() const { return dirty_chunks_.size(); }
+
+    // One chunk and its version, as carried by MessageType::ChunkData. Returns false and
+    // writes nothing if there is no chunk at chunk_origin.
+    bool serialize_chunk(Serializer& s, TilePos chunk_origin) const;
+
+    // Apply a serialize_chunk payload, replacing or creating the chunk and taking its version
+    // (content_version() is raised to it, so later local changes still stamp higher).
+    // Returns false and leaves the map alone if the origin isn't a chunk origin in bounds.
+    // Throws DeserializeError on truncated data.
+    bool deserialize_chunk(Deserializer& d);
+
     // ========== Line of Sight ==========
 
-    // Check if there's line of sight between two positions
+    // Check if there's line of sight between two positions (no opaque tile strictly between
+    // them on the get_line path). Streams the line without allocating and reads the chunk
+    // Opaque planes, looking a chunk up only when the line enters it.
     bool has_line_of_sight(TilePos from, TilePos to) const;
 
     // Get all tiles along a line (Bresenham)
     static std::vector<TilePos> get_line(TilePos from, TilePos to);
 
+    // Visit the get_line tiles in order without materialising them. visit(TilePos) returns
+    // false to stop early; walk_line then returns false too.
+    template<typename Visit>
+    static bool walk_line(TilePos from, TilePos to, Visit&& visit) {
+        i32 dx = std::abs(to.x - from.x);
+        i32 dy = std::abs(to.y - from.y);
+        i32 sx = from.x < to.x ? 1 : -1;
+        i32 sy = from.y < to.y ? 1 : -1;
+        i32 err = dx - dy;
+
+        TilePos current = from;
+        while (true) {
+            if (!visit(current)) return false;
+            if (current == to) return true;
+
+            i32 e2 = 2 * err;
+            if (e2 > -dy) {
+                err -= dy;
+                current.x += sx;
+            }
+            if (e2 < dx) {
+                err += dx;
+                current.y += sy;
+            }
+        }
+    }
+
     // ========== Serialization ==========
 
     void serialize(Serializer& s) const;
@@ -80,9 +182,39 @@ public:
     size_t chunk_count() const { return chunks_.size(); }
 
 private:
+    // Writable chunk for an origin, created if needed
+    Chunk& chunk_for_write(TilePos chunk_origin);
+
+    // Hash-path lookup used for unbounded maps
+    const Tile* find_tile(TilePos pos) const;
+
+    size_t grid_index(i32 chunk_x, i32 chunk_y) const {
+        return static_cast<size_t>(chunk_y) * static_cast<size_t>(grid_width_) +
+               static_cast<size_t>(chunk_x);
+    }
+
+    // Slot for a chunk origin in chunk_grid_ (nullptr if the map is unbounded or the origin
+    // lies outside the bounds)
+    Chunk** grid_slot(TilePos chunk_origin);
+
+    // Re-register every owned chunk in chunk_grid_ after bounds or chunks changed wholesale
+    void rebuild_chunk_grid();
+
+    // Stamp a created or changed chunk with the next content version and queue it for
+    // drain_dirty_chunks unless it already is
+    void mark_dirty(Chunk& chunk);
+
     i32 width_{0};
     i32 height_{0};
     std::unordered_map<TilePos, std::unique_ptr<Chunk>> chunks_;
+    u32 mask_version_{0};
+    u32 content_version_{0};
+    std::vector<TilePos> dirty_chunks_;
+
+    // Dense chunk lookup for bounded maps (row-major, grid_width_ chunks per row)
+    i32 grid_width_{0};
+    i32 grid_height_{0};
+    std::vector<Chunk*> chunk_grid_;
 };
 
 } // namespace city
@@ -0,0 +1,58 @@
+#include "compression.hpp"
+#include <zstd.h>
+#include <algorithm>
+
+namespace city::net {
+
+namespace {
+
+// Chunk batches are small and sent from the tick loop: favour speed
+constexpr int COMPRESSION_LEVEL = 1;
+
+} // namespace
+
+std::vector<u8> pack_payload(std::span<const u8> body) {
+    std::vector<u8> payload;
+    if (body.size() >= MIN_COMPRESS_SIZE) {
+        payload.resize(1 + ZSTD_compressBound(body.size()));
+        size_t size = ZSTD_compress(payload.data() + 1, payload.size() - 1, body.data(),
+                                    body.size(), COMPRESSION_LEVEL);
+        if (!ZSTD_isError(size) && size < body.size()) {
+            payload[0] = static_cast<u8>(PayloadCodec::Zstd);
+            payload.resize(1 + size);
+            return payload;
+        }
+    }
+
+    payload.resize(1 + body.size());
+    payload[0] = static_cast<u8>(PayloadCodec::Raw);
+    std::copy(body.begin(), body.end(), payload.begin() + 1);
+    return payload;
+}
+
+std::vector<u8> unpack_payload(std::span<const u8> payload) {
+    if (payload.empty()) throw DeserializeError("unexpected end of data");
+
+    std::span<const u8> data = payload.subspan(1);
+    switch (static_cast<PayloadCodec>(payload[0])) {
+        case PayloadCodec::Raw:
+            return {data.begin(), data.end()};
+
+        case PayloadCodec::Zstd: {
+            unsigned long long size = ZSTD_getFrameContentSize(data.data(), data.size());
+            if (size == ZSTD_CONTENTSIZE_ERROR || size == ZSTD_CONTENTSIZE_UNKNOWN ||
+                size > MAX_UNPACKED_SIZE) {
+                throw DeserializeError("bad compressed payload");
+            }
+            std::vector<u8> body(static_cast<size_t>(size));
+            size_t written = ZSTD_decompress(body.data(), body.size(), data.data(), data.size());
+            if (ZSTD_isError(written) || written != body.size()) {
+                throw DeserializeError("bad compressed payload");
+            }
+            return body;
+        }
+    }
+    throw DeserializeError("unknown payload codec");
+}
+
+} // namespace city::net
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "serialization.hpp"
+#include <span>
+#include <vector>
+
+namespace city::net {
+
+// Framing for message payloads that may be zstd-compressed: a PayloadCodec byte followed by
+// the body, raw or as one zstd frame
+enum class PayloadCodec : u8 {
+    Raw = 0,
+    Zstd = 1,
+};
+
+// Bodies shorter than this aren't worth a compression attempt
+constexpr size_t MIN_COMPRESS_SIZE = 128;
+
+// Largest body unpack_payload will inflate to
+constexpr size_t MAX_UNPACKED_SIZE = 1 << 20;
+
+// Frame body, compressing it if it is at least MIN_COMPRESS_SIZE bytes and that saves space
+std::vector<u8> pack_payload(std::span<const u8> body);
+
+// Undo pack_payload. Throws DeserializeError on an unknown codec, corrupt data or a body
+// over MAX_UNPACKED_SIZE.
+std::vector<u8> unpack_payload(std::span<const u8> payload);
+
+} // namespace city::net
@@ -18,6 +18,9 @@ constexpr u32 MAX_PLAYERS = 100;
 constexpr u32 MAX_PACKET_SIZE = 1400; // Safe MTU size
 constexpr u32 MAX_MESSAGE_SIZE = 65536; // For fragmented messages
 
+// Tile replication: chunks sent around the player's chunk, in each direction
+constexpr i32 CHUNK_VIEW_DISTANCE = 2;
+
 // Content transfer
 constexpr u32 CONTENT_CHUNK_SIZE = 65536; // 64KB chunks
 
@@ -0,0 +1,137 @@
+#include "job_system.hpp"
+
+namespace city {
+
+namespace {
+
+// Pool that owns the current thread (null for threads not owned by any JobSystem) and the
+// thread's index in it
+thread_local const JobSystem* t_owner = nullptr;
+thread_local u32 t_thread_index = 0;
+
+} // namespace
+
+JobSystem::JobSystem(u32 worker_count) {
+    queues_.reserve(static_cast<size_t>(worker_count) + 1);
+    for (u32 i = 0; i <= worker_count; ++i) {
+        queues_.push_back(std::make_unique<WorkQueue>());
+    }
+
+    workers_.reserve(worker_count);
+    for (u32 i = 1; i <= worker_count; ++i) {
+        workers_.emplace_back([this, i] { worker_loop(i); });
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard lock(sleep_mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+u32 JobSystem::default_worker_count() {
+    u32 hardware = std::thread::hardware_concurrency();
+    return hardware > 1 ? hardware - 1 : 0;
+}
+
+u32 JobSystem::thread_index() const {
+    return t_owner == this ? t_thread_index : 0;
+}
+
+u32 JobSystem::current_thread_index() {
+    return t_thread_index;
+}
+
+void JobSystem::worker_loop(u32 index) {
+    t_owner = this;
+    t_thread_index = index;
+
+    while (true) {
+        Job job{};
+        if (try_take(job)) {
+            execute(job);
+            continue;
+        }
+
+        std::unique_lock lock(sleep_mutex_);
+        wake_.wait(lock, [this] { return stopping_ || queued_jobs_ > 0; });
+        if (stopping_) return;
+    }
+}
+
+void JobSystem::push(const Job& job) {
+    u32 index = thread_index();
+    {
+        std::lock_guard lock(queues_[index]->mutex);
+        queues_[index]->jobs.push_back(job);
+    }
+    ++queued_jobs_;
+
+    // Taking the sleep mutex orders the notify after any in-progress predicate check
+    { std::lock_guard lock(sleep_mutex_); }
+    wake_.notify_one();
+}
+
+bool JobSystem::try_take(Job& out) {
+    if (queued_jobs_ == 0) return false;
+
+    size_t own = thread_index();
+
+    // Own deque: newest first (best cache locality for the range we just split)
+    {
+        auto& queue = *queues_[own];
+        std::lock_guard lock(queue.mutex);
+        if (!queue.jobs.empty()) {
+            out = queue.jobs.back();
+            queue.jobs.pop_back();
+            --queued_jobs_;
+            return true;
+        }
+    }
+
+    // Steal: oldest first (largest remaining ranges)
+    for (size_t offset = 1; offset < queues_.size(); ++offset) {
+        auto& queue = *queues_[(own + offset) % queues_.size()];
+        std::lock_guard lock(queue.mutex);
+        if (!queue.jobs.empty()) {
+            out = queue.jobs.front();
+            queue.jobs.pop_front();
+            --queued_jobs_;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void JobSystem::execute(Job job) {
+    while (job.end - job.begin > job.grain) {
+        size_t mid = job.begin + (job.end - job.begin) / 2;
+        Job upper = job;
+        upper.begin = mid;
+        push(upper);
+        job.end = mid;
+    }
+
+    job.fn(job.context, job.begin, job.end);
+    job.remaining->fetch_sub(job.end - job.begin, std::memory_order_acq_rel);
+}
+
+void JobSystem::wait(const std::atomic<size_t>& remaining) {
+    while (remaining.load(std::memory_order_acquire) > 0) {
+        Job job{};
+        if (try_take(job)) {
+            execute(job);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+} // namespace city
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "types.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace city {
+
+// Fixed pool of worker threads with per-thread work-stealing deques.
+//
+// parallel_for() pushes one job for the whole range; whoever runs a job larger than the
+// grain size splits it, keeps the lower half and pushes the upper half onto its own deque.
+// Idle threads steal from the front of other deques (the largest remaining halves), so
+// uneven work balances itself without a central queue. The calling thread participates
+// until its range is finished, which also makes nested parallel_for calls safe.
+//
+// Job functions must not throw.
+class JobSystem {
+public:
+    // worker_count = 0 runs everything inline on the calling thread
+    explicit JobSystem(u32 worker_count = default_worker_count());
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // hardware_concurrency - 1 (the caller thread is the remaining one)
+    static u32 default_worker_count();
+
+    // Number of background workers
+    u32 worker_count() const { return static_cast<u32>(workers_.size()); }
+
+    // Threads that can execute jobs concurrently (workers + calling thread)
+    u32 thread_count() const { return worker_count() + 1; }
+
+    // Index of the current thread in this pool: 1..worker_count() on its workers, 0 on any
+    // other thread (including workers of other pools). Use it to index per-thread scratch
+    // buffers sized by thread_count().
+    u32 thread_index() const;
+
+    // Index of the current thread in whichever pool owns it, 0 if none. Not bounded by any
+    // particular pool's thread_count(): good for spreading work over buffers (modulo their
+    // count), not for indexing. Prefer thread_index() when the pool is known.
+    static u32 current_thread_index();
+
+    // Call func(begin, end) over disjoint sub-ranges covering [0, count), each at most
+    // grain elements long. Blocks until every sub-range has finished.
+    template<typename Func>
+    void parallel_for(size_t count, size_t grain, Func&& func) {
+        if (count == 0) return;
+        if (grain == 0) grain = 1;
+        if (workers_.empty() || count <= grain) {
+            func(size_t{0}, count);
+            return;
+        }
+
+        std::atomic<size_t> remaining{count};
+        Job job{
+            [](void* context, size_t begin, size_t end) {
+                (*static_cast<std::remove_reference_t<Func>*>(context))(begin, end);
+            },
+            &func, 0, count, grain, &remaining};
+        push(job);
+        wait(remaining);
+    }
+
+private:
+    struct Job {
+        void (*fn)(void* context, size_t begin, size_t end);
+        void* context;
+        size_t begin;
+        size_t end;
+        size_t grain;
+        std::atomic<size_t>* remaining;  // Elements not yet processed for this parallel_for
+    };
+
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    void worker_loop(u32 index);
+
+    // Push onto the current thread's deque and wake a sleeping worker
+    void push(const Job& job);
+
+    // Pop from own deque (LIFO), otherwise steal from another (FIFO)
+    bool try_take(Job& out);
+
+    // Split down to grain size, run, and report completion
+    void execute(Job job);
+
+    // Help run jobs until remaining reaches zero
+    void wait(const std::atomic<size_t>& remaining);
+
+    std::vector<std::thread> workers_;
+    std::vector<std::unique_ptr<WorkQueue>> queues_;  // [0] = external threads, [i] = worker i
+    std::atomic<size_t> queued_jobs_{0};
+    std::atomic<bool> stopping_{false};
+
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+};
+
+} // namespace city
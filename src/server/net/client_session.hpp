@@ -2,8 +2,11 @@
 
 #include "core/net/message.hpp"
 #include "core/ecs/entity.hpp"
+#include "core/grid/tile.hpp"
+#include <optional>
 #include <string>
 #include <queue>
+#include <unordered_map>
 
 namespace city {
 
@@ -23,9 +26,22 @@ public:
     SessionState state() const { return state_; }
     NetEntityId player_entity() const { return player_entity_; }
 
+    // Latest server tick whose state the client reported receiving (0 = none yet)
+    u32 acked_tick() const { return acked_tick_; }
+
     void set_name(const std::string& name) { name_ = name; }
     void set_state(SessionState state) { state_ = state; }
     void set_player_entity(NetEntityId id) { player_entity_ = id; }
+    void acknowledge_tick(u32 tick) {
+        if (tick > acked_tick_) acked_tick_ = tick;
+    }
+
+    // Tile replication (ChunkSync): the Chunk::version last sent for each chunk origin, and
+    // the chunk (in chunk coordinates) the player was in last tick. ChunkData is reliable
+    // and ordered, so a version sent is a version the client will have.
+    std::unordered_map<TilePos, u32>& sent_chunk_versions() { return sent_chunk_versions_; }
+    std::optional<TilePos> view_chunk() const { return view_chunk_; }
+    void set_view_chunk(TilePos chunk) { view_chunk_ = chunk; }
 
     void send(net::Message msg, net::Reliability reliability = net::Reliability::ReliableOrdered);
 
@@ -40,6 +56,9 @@ private:
     std::string name_{"Player"};
     SessionState state_{SessionState::Connected};
     NetEntityId player_entity_{INVALID_NET_ENTITY_ID};
+    u32 acked_tick_{0};
+    std::unordered_map<TilePos, u32> sent_chunk_versions_;
+    std::optional<TilePos> view_chunk_;
     std::queue<net::Message> pending_messages_;
 };
 
@@ -105,6 +105,13 @@ void TickProfiler::end_scope(std::string_view name) {
     current_scope_.clear();
 }
 
+void TickProfiler::record_scope(std::string_view name, f64 duration_us) {
+    auto& entry = scopes_[std::string(name)];
+    entry.accumulated_us += duration_us;
+    entry.max_us = std::max(entry.max_us, duration_us);
+    entry.call_count++;
+}
+
 const TickProfile& TickProfiler::latest() const {
     if (history_.empty()) {
         return current_tick_;
@@ -113,6 +113,15 @@ struct SpikeRecord {
     f64 worst_phase_time_ms;
 };
 
+// Memory held by one ECS component pool (see World::component_memory_report)
+struct PoolMemoryUsage {
+    std::string name;
+    size_t component_count{0};
+    size_t sparse_pages{0};
+    size_t sparse_bytes{0};
+    size_t dense_bytes{0};
+};
+
 // Main profiler class
 class TickProfiler {
 public:
@@ -134,6 +143,9 @@ public:
     void begin_scope(std::string_view name);
     void end_scope(std::string_view name);
 
+    // Add an externally measured sample to a scope (e.g., systems timed on worker threads)
+    void record_scope(std::string_view name, f64 duration_us);
+
     // --- Metrics API ---
     void set_entity_count(u32 count) { current_tick_.entity_count = count; }
     void set_player_count(u32 count) { current_tick_.player_count = count; }
@@ -169,6 +181,10 @@ public:
     // --- Memory tracking ---
     void update_memory_usage();
 
+    // Latest per-pool breakdown (sampled by the server, not per tick)
+    void set_pool_memory(std::vector<PoolMemoryUsage> pools) { pool_memory_ = std::move(pools); }
+    const std::vector<PoolMemoryUsage>& pool_memory() const { return pool_memory_; }
+
 private:
     using Clock = std::chrono::high_resolution_clock;
     using TimePoint = Clock::time_point;
@@ -198,6 +214,7 @@ private:
 
     // Memory tracking
     size_t last_memory_usage_{0};
+    std::vector<PoolMemoryUsage> pool_memory_;
 };
 
 // RAII scope timer for phases
@@ -604,6 +604,44 @@ void ProfilerWindow::render_memory_usage() {
         ImGui::ProgressBar(progress, ImVec2(300, 0));
     }
 
+    // Per-pool breakdown of ECS component storage
+    const auto& pools = profiler_->pool_memory();
+    if (!pools.empty()) {
+        ImGui::Spacing();
+        ImGui::Text("Component Pools:");
+
+        ImGui::BeginChild("pool_memory_list", ImVec2(0, 150), ImGuiChildFlags_Border);
+        ImGui::Columns(5, "pool_memory_columns");
+        ImGui::SetColumnWidth(0, 180);
+        ImGui::SetColumnWidth(1, 90);
+        ImGui::SetColumnWidth(2, 110);
+        ImGui::SetColumnWidth(3, 90);
+        ImGui::SetColumnWidth(4, 90);
+
+        ImGui::Text("Component"); ImGui::NextColumn();
+        ImGui::Text("Count"); ImGui::NextColumn();
+        ImGui::Text("Sparse (pages)"); ImGui::NextColumn();
+        ImGui::Text("Dense"); ImGui::NextColumn();
+        ImGui::Text("Total"); ImGui::NextColumn();
+        ImGui::Separator();
+
+        for (const auto& pool : pools) {
+            ImGui::Text("%s", pool.name.c_str()); ImGui::NextColumn();
+            ImGui::Text("%zu", pool.component_count); ImGui::NextColumn();
+            ImGui::Text("%.1f KB (%zu)", static_cast<float>(pool.sparse_bytes) / 1024.0f,
+                        pool.sparse_pages);
+            ImGui::NextColumn();
+            ImGui::Text("%.1f KB", static_cast<float>(pool.dense_bytes) / 1024.0f);
+            ImGui::NextColumn();
+            ImGui::Text("%.1f KB",
+                        static_cast<float>(pool.sparse_bytes + pool.dense_bytes) / 1024.0f);
+            ImGui::NextColumn();
+        }
+
+        ImGui::Columns(1);
+        ImGui::EndChild();
+    }
+
     ImGui::Spacing();
 }
 
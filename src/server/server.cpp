@@ -5,9 +5,15 @@
 #include "simulation/round_manager.hpp"
 #include "systems/input_processor.hpp"
 #include "systems/entity_sync.hpp"
+#include "systems/chunk_sync.hpp"
 #include "core/game/components/transform.hpp"
 #include "core/game/components/player.hpp"
+#include "core/game/systems/spatial_index.hpp"
+#include "core/game/systems/visibility.hpp"
+#include "core/ecs/command_buffer.hpp"
+#include "core/util/job_system.hpp"
 
+#include <algorithm>
 #include <iostream>
 #include <chrono>
 #include <thread>
@@ -19,11 +25,17 @@ Server::~Server() = default;
 
 bool Server::init() {
     // Initialize subsystems
+    job_system_ = std::make_unique<JobSystem>();
     connection_ = std::make_unique<ServerConnection>(*this);
     game_state_ = std::make_unique<GameState>(world_, tilemap_);
     round_manager_ = std::make_unique<RoundManager>(*this);
-    input_processor_ = std::make_unique<InputProcessor>(world_, tilemap_);
+    input_processor_ = std::make_unique<InputProcessor>(world_, tilemap_, *job_system_);
     entity_sync_ = std::make_unique<EntitySync>(world_);
+    chunk_sync_ = std::make_unique<ChunkSync>(world_, tilemap_);
+    spatial_index_ = std::make_unique<SpatialIndex>();
+    spatial_index_->attach(world_);
+    visibility_ = std::make_unique<VisibilitySystem>(tilemap_, SHOUT_RANGE);
+    world_.set_job_system(job_system_.get());
 
     // Load content manifest
     manifest_ = ContentManifest::from_directory("content", "official");
@@ -216,12 +228,17 @@ void Server::run() {
 }
 
 void Server::update(f32 dt) {
+    // Component writes during this tick are stamped with it (see EntitySync::broadcast)
+    world_.set_change_tick(current_tick_);
+
 #ifdef ENABLE_PROFILING
     profiler_.begin_phase(TickPhase::InputProcessing);
     profiler_.begin_scope("input_processor");
 #endif
     // Process queued inputs
     input_processor_->update(world_, dt);
+    // Sync point: apply structural changes recorded since the last tick
+    world_.flush_commands();
 #ifdef ENABLE_PROFILING
     profiler_.end_scope("input_processor");
     profiler_.end_phase();
@@ -232,8 +249,31 @@ void Server::update(f32 dt) {
 #endif
     // Update game systems
     world_.update(dt);
+    // Sync point: apply structural changes recorded by systems, then let deferred
+    // component signal subscribers catch up on this tick's changes
+    world_.flush_commands();
+    world_.dispatch_signals();
 #ifdef ENABLE_PROFILING
     profiler_.end_scope("world_update");
+    profiler_.begin_scope("visibility");
+#endif
+    // Who sees what this tick, for chat routing and interest management
+    update_visibility();
+#ifdef ENABLE_PROFILING
+    profiler_.end_scope("visibility");
+    for (const auto& timing : world_.system_timings()) {
+        profiler_.record_scope(timing.name, timing.time_us);
+    }
+    // Component pool memory changes slowly; sample it once a second
+    if (current_tick_ % static_cast<u32>(net::TICK_RATE) == 0) {
+        std::vector<PoolMemoryUsage> pools;
+        for (const auto& report : world_.component_memory_report()) {
+            pools.push_back({std::string(report.name), report.stats.component_count,
+                             report.stats.sparse_pages, report.stats.sparse_bytes,
+                             report.stats.dense_bytes});
+        }
+        profiler_.set_pool_memory(std::move(pools));
+    }
     profiler_.end_phase();
 
     profiler_.begin_phase(TickPhase::RoundManager);
@@ -254,6 +294,63 @@ void Server::process_network() {
 void Server::broadcast_state() {
     // Build delta state and send to all clients
     entity_sync_->broadcast(*connection_, current_tick_);
+
+    // Tiles that changed, or came into view, since each client was last sent them
+    chunk_sync_->update(*connection_);
+}
+
+void Server::update_visibility() {
+    visibility_ids_.clear();
+    visibility_tiles_.clear();
+    viewer_index_.clear();
+    world_.each<Transform, Player>([this](Entity e, Transform& transform, Player&) {
+        NetEntityId net_id = world_.get_net_id(e);
+        if (net_id == INVALID_NET_ENTITY_ID) return;
+        viewer_index_.emplace(net_id, visibility_ids_.size());
+        visibility_ids_.push_back(net_id);
+        visibility_tiles_.push_back(TilePos::from_world(transform.position));
+    });
+    visibility_viewers_ = visibility_ids_.size();
+    world_.each<Transform>([this](Entity e, Transform& transform) {
+        NetEntityId net_id = world_.get_net_id(e);
+        if (net_id == INVALID_NET_ENTITY_ID || world_.has_component<Player>(e)) return;
+        visibility_ids_.push_back(net_id);
+        visibility_tiles_.push_back(TilePos::from_world(transform.position));
+    });
+
+    std::span<const TilePos> tiles(visibility_tiles_);
+    visibility_->update(tiles.first(visibility_viewers_), tiles, *job_system_);
+}
+
+void Server::route_local_chat(ClientSession& sender, const net::Message& msg) {
+    auto speaker_it = viewer_index_.find(sender.player_entity());
+    Entity speaker_entity = world_.get_by_net_id(sender.player_entity());
+    const Transform* speaker_transform = world_.get_component<Transform>(speaker_entity);
+    if (speaker_it == viewer_index_.end() || !speaker_transform) {
+        // Joined since the last tick: nobody has seen them yet
+        sender.send(msg);
+        return;
+    }
+
+    // The index and the visibility inputs both reflect the end of the last tick. Range is
+    // measured between tiles below; the query only has to cover every candidate, and a
+    // position is at most half a tile diagonal from its tile's centre
+    size_t speaker = speaker_it->second;
+    TilePos origin = visibility_tiles_[speaker];
+    constexpr f32 QUERY_RADIUS = static_cast<f32>(LOCAL_CHAT_RANGE) + 1.5f;
+    spatial_index_->query_radius(speaker_transform->position, QUERY_RADIUS, nearby_);
+    for (Entity e : nearby_) {
+        const Player* player = world_.get_component<Player>(e);
+        if (!player) continue;
+        auto listener_it = viewer_index_.find(world_.get_net_id(e));
+        if (listener_it == viewer_index_.end()) continue;
+        size_t index = listener_it->second;
+        TilePos offset = visibility_tiles_[index] - origin;
+        if (visibility_->sees(speaker, index) &&
+            offset.x * offset.x + offset.y * offset.y <= LOCAL_CHAT_RANGE * LOCAL_CHAT_RANGE) {
+            connection_->send(player->session_id, msg);
+        }
+    }
 }
 
 void Server::on_client_connected(ClientSession& session) {
@@ -332,10 +429,10 @@ void Server::on_client_disconnected(ClientSession& session) {
     };
     connection_->broadcast(net::Message::create(net::MessageType::EntityDespawn, despawn));
 
-    // Remove player entity
+    // Remove player entity (deferred to the next sync point in update())
     Entity player = world_.get_by_net_id(session.player_entity());
     if (player.is_valid()) {
-        world_.destroy(player);
+        world_.commands().destroy(player);
     }
 }
 
@@ -345,6 +442,8 @@ void Server::on_client_message(ClientSession& session, const net::Message& msg)
             net::PlayerInputPayload input;
             auto reader = msg.reader();
             input.deserialize(reader);
+            // Never trust an ack from the future; it would suppress needed deltas
+            session.acknowledge_tick(std::min(input.last_received_tick, current_tick_));
             input_processor_->set_input(session.player_entity(), input);
             break;
         }
@@ -353,8 +452,12 @@ void Server::on_client_message(ClientSession& session, const net::Message& msg)
             net::ChatPayload chat;
             auto reader = msg.reader();
             chat.deserialize(reader);
-            // Broadcast to all clients
-            connection_->broadcast(net::Message::create(net::MessageType::ChatBroadcast, chat));
+            auto broadcast = net::Message::create(net::MessageType::ChatBroadcast, chat);
+            if (chat.channel == net::ChatChannel::Local) {
+                route_local_chat(session, broadcast);
+            } else {
+                connection_->broadcast(std::move(broadcast));
+            }
             break;
         }
 
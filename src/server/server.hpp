@@ -13,6 +13,8 @@
 
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace city {
 
@@ -23,6 +25,10 @@ class GameState;
 class RoundManager;
 class InputProcessor;
 class EntitySync;
+class ChunkSync;
+class JobSystem;
+class VisibilitySystem;
+class SpatialIndex;
 
 class Server {
 public:
@@ -45,6 +51,7 @@ public:
     // Accessors
     World& world() { return world_; }
     TileMap& tilemap() { return tilemap_; }
+    const SpatialIndex& spatial_index() const { return *spatial_index_; }
     u32 current_tick() const { return current_tick_; }
 
 #ifdef ENABLE_PROFILING
@@ -67,6 +74,13 @@ private:
     void process_network();
     void broadcast_state();
 
+    // Recompute who sees what for this tick (players see entities)
+    void update_visibility();
+
+    // Send a Local chat line to the players who could see the sender last tick, looking
+    // listeners up in the spatial index
+    void route_local_chat(ClientSession& sender, const net::Message& msg);
+
     bool running_{false};
     u32 current_tick_{0};
 
@@ -76,11 +90,23 @@ private:
     ContentManifest manifest_;
 
     // Subsystems
+    std::unique_ptr<JobSystem> job_system_;
     std::unique_ptr<ServerConnection> connection_;
     std::unique_ptr<GameState> game_state_;
     std::unique_ptr<RoundManager> round_manager_;
     std::unique_ptr<InputProcessor> input_processor_;
     std::unique_ptr<EntitySync> entity_sync_;
+    std::unique_ptr<ChunkSync> chunk_sync_;
+    std::unique_ptr<SpatialIndex> spatial_index_;   // Transforms, as of the last dispatch
+    std::unique_ptr<VisibilitySystem> visibility_;
+
+    // Visibility inputs of the last tick: players first (viewer i is target i), then the
+    // other networked entities
+    std::vector<NetEntityId> visibility_ids_;
+    std::vector<TilePos> visibility_tiles_;
+    size_t visibility_viewers_{0};
+    std::unordered_map<NetEntityId, size_t> viewer_index_;
+    std::vector<Entity> nearby_;    // Scratch for spatial index queries
 
 #ifdef ENABLE_PROFILING
     // Profiling
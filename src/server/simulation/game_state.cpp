@@ -43,22 +43,4 @@ void GameState::serialize_full(Serializer& s) const {
     });
 }
 
-void GameState::serialize_delta(Serializer& s, u32 /*since_tick*/) const {
-    // TODO: Track dirty components and only serialize changes
-    // For now, just serialize all entity positions
-    u32 count = 0;
-    world_.each<Transform>([&count](Entity, Transform&) { ++count; });
-
-    s.write_u32(count);
-
-    world_.each<Transform>([this, &s](Entity e, Transform& transform) {
-        NetEntityId net_id = world_.get_net_id(e);
-        if (net_id == INVALID_NET_ENTITY_ID) return;
-
-        s.write_u32(net_id);
-        s.write_vec2f(transform.position);
-        s.write_vec2f(transform.velocity);
-    });
-}
-
 } // namespace city
@@ -13,9 +13,6 @@ public:
     // Serialize full state for new clients
     void serialize_full(Serializer& s) const;
 
-    // Serialize delta since last tick
-    void serialize_delta(Serializer& s, u32 since_tick) const;
-
 private:
     World& world_;
     TileMap& tilemap_;
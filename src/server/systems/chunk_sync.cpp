@@ -0,0 +1,79 @@
+#include "chunk_sync.hpp"
+#include "core/game/components/transform.hpp"
+#include "core/net/compression.hpp"
+#include "core/net/protocol.hpp"
+#include <cstdlib>
+
+namespace city {
+
+ChunkSync::ChunkSync(World& world, TileMap& tilemap) : world_(world), tilemap_(tilemap) {}
+
+void ChunkSync::update(ServerConnection& connection) {
+    last_sent_ = 0;
+    tilemap_.drain_dirty_chunks(dirty_);
+
+    connection.for_each_session([this](ClientSession& session) {
+        Entity player = world_.get_by_net_id(session.player_entity());
+        const Transform* transform = world_.get_component<Transform>(player);
+        if (!transform) return;
+
+        TilePos tile = TilePos::from_world(transform->position);
+        TilePos center{tile.x >> CHUNK_SHIFT, tile.y >> CHUNK_SHIFT};
+        constexpr i32 range = net::CHUNK_VIEW_DISTANCE;
+
+        pending_.clear();
+        if (session.view_chunk() != center) {
+            session.set_view_chunk(center);
+            for (i32 cy = center.y - range; cy <= center.y + range; ++cy) {
+                for (i32 cx = center.x - range; cx <= center.x + range; ++cx) {
+                    queue_chunk(session, {cx << CHUNK_SHIFT, cy << CHUNK_SHIFT});
+                }
+            }
+        } else {
+            for (TilePos origin : dirty_) {
+                if (std::abs((origin.x >> CHUNK_SHIFT) - center.x) <= range &&
+                    std::abs((origin.y >> CHUNK_SHIFT) - center.y) <= range) {
+                    queue_chunk(session, origin);
+                }
+            }
+        }
+        send_pending(session);
+    });
+}
+
+void ChunkSync::queue_chunk(ClientSession& session, TilePos chunk_origin) {
+    const Chunk* chunk = tilemap_.get_chunk(chunk_origin);
+    if (!chunk) return;
+
+    auto& sent = session.sent_chunk_versions();
+    auto [it, inserted] = sent.try_emplace(chunk_origin, chunk->version());
+    if (!inserted) {
+        if (it->second == chunk->version()) return;
+        it->second = chunk->version();
+    }
+    pending_.push_back(chunk_origin);
+}
+
+void ChunkSync::send_pending(ClientSession& session) {
+    Serializer chunks;
+    u16 count = 0;
+    auto flush = [&] {
+        Serializer body;
+        body.write_u16(count);
+        body.write_bytes(chunks.data());
+        session.send(net::Message{net::MessageType::ChunkData, net::pack_payload(body.data())},
+                     net::Reliability::ReliableOrdered);
+        chunks.clear();
+        count = 0;
+    };
+
+    for (TilePos origin : pending_) {
+        tilemap_.serialize_chunk(chunks, origin);
+        ++count;
+        ++last_sent_;
+        if (chunks.size() >= MAX_BATCH_SIZE) flush();
+    }
+    if (count > 0) flush();
+}
+
+} // namespace city
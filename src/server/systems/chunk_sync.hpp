@@ -0,0 +1,43 @@
+#pragma once
+
+#include "core/ecs/world.hpp"
+#include "core/grid/tilemap.hpp"
+#include "../net/server_connection.hpp"
+#include <vector>
+
+namespace city {
+
+// Replicates the tile map: each client is sent, as ChunkData, the chunks within
+// CHUNK_VIEW_DISTANCE of its player's chunk whose Chunk::version differs from the one it
+// was last sent. Changed chunks come from the TileMap dirty list, drained once per tick, so
+// a door toggle costs one chunk message to the clients that can see it; a client whose
+// player crossed into another chunk has its whole window compared instead. A client's
+// chunks for the tick go out batched in as few messages as possible, zstd-compressed
+// (net::pack_payload) on top of the compact chunk encoding.
+class ChunkSync {
+public:
+    ChunkSync(World& world, TileMap& tilemap);
+
+    void update(ServerConnection& connection);
+
+    // Chunks sent by the last update
+    u32 last_sent() const { return last_sent_; }
+
+private:
+    // Uncompressed chunk bytes per ChunkData message, well inside MAX_MESSAGE_SIZE
+    static constexpr size_t MAX_BATCH_SIZE = 16 * 1024;
+
+    // Queue the chunk at origin unless the session already has its current version
+    void queue_chunk(ClientSession& session, TilePos chunk_origin);
+
+    // Send the queued chunks as ChunkData
+    void send_pending(ClientSession& session);
+
+    World& world_;
+    TileMap& tilemap_;
+    std::vector<TilePos> dirty_;    // Scratch: chunks changed since the last update
+    std::vector<TilePos> pending_;  // Scratch: chunks to send the current session
+    u32 last_sent_{0};
+};
+
+} // namespace city
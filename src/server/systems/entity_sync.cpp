@@ -1,28 +1,52 @@
 #include "entity_sync.hpp"
 #include "core/game/components/transform.hpp"
 #include "core/game/components/player.hpp"
+#include <algorithm>
 
 namespace city {
 
 EntitySync::EntitySync(World& world) : world_(world) {}
 
 void EntitySync::broadcast(ServerConnection& connection, u32 tick) {
+    // Components are stamped with the tick that was simulated; a client that acknowledged
+    // tick A has every change stamped before A, so only stamps >= min(A) need to go out.
+    // Clients that haven't acknowledged anything yet (A = 0) get everything.
+    u32 since_tick = tick;
+    connection.for_each_session([&since_tick](ClientSession& session) {
+        since_tick = std::min(since_tick, session.acked_tick());
+    });
+    if (tick % FULL_REFRESH_INTERVAL == 0) {
+        since_tick = 0;
+    }
+
+    // Collect entities whose replicated components changed. An entity can show up in both
+    // pools, so merge by entity; the delta always carries a Transform
+    changed_.clear();
+    world_.each_changed_since<Transform>(since_tick, [this](Entity e, Transform&) {
+        changed_.push_back({e, INVALID_NET_ENTITY_ID});
+    });
+    world_.each_changed_since<Player>(since_tick, [this](Entity e, Player&) {
+        changed_.push_back({e, INVALID_NET_ENTITY_ID});
+    });
+    std::sort(changed_.begin(), changed_.end(), [](const auto& a, const auto& b) {
+        return a.first.index < b.first.index;
+    });
+    changed_.erase(std::unique(changed_.begin(), changed_.end()), changed_.end());
+    for (auto& [e, net_id] : changed_) {
+        net_id = world_.get_net_id(e);
+    }
+    std::erase_if(changed_, [this](const auto& entry) {
+        return entry.second == INVALID_NET_ENTITY_ID || !world_.has_component<Transform>(entry.first);
+    });
+
     // Build delta state message
     Serializer s;
     s.write_u32(tick);
-
-    // Count entities with valid net IDs
-    u32 count = 0;
-    world_.each<Transform>([this, &count](Entity e, Transform&) {
-        if (world_.get_net_id(e) != INVALID_NET_ENTITY_ID) ++count;
-    });
-    s.write_u32(count);
+    s.write_u32(static_cast<u32>(changed_.size()));
 
     // Serialize entity states
-    world_.each<Transform>([this, &s](Entity e, Transform& transform) {
-        NetEntityId net_id = world_.get_net_id(e);
-        if (net_id == INVALID_NET_ENTITY_ID) return;
-
+    for (auto [e, net_id] : changed_) {
+        const auto& transform = *world_.get_component<Transform>(e);
         s.write_u32(net_id);
         s.write_vec2f(transform.position);
         s.write_vec2f(transform.velocity);
@@ -36,7 +60,7 @@ void EntitySync::broadcast(ServerConnection& connection, u32 tick) {
             s.write_vec2i(player->move_target);
             s.write_vec2i(player->input_direction);
         }
-    });
+    }
 
     connection.broadcast(
         net::Message{net::MessageType::DeltaState, s.take()},
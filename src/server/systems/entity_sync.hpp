@@ -9,14 +9,18 @@ class EntitySync {
 public:
     explicit EntitySync(World& world);
 
-    // Broadcast state to all clients
+    // Broadcast state of entities changed since the oldest tick any client acknowledged
     void broadcast(ServerConnection& connection, u32 tick);
 
     // Send full state to a specific client
     void send_full_state(ClientSession& session, u32 tick);
 
 private:
+    // Every this many ticks all entities are sent regardless of change stamps
+    static constexpr u32 FULL_REFRESH_INTERVAL = 60;
+
     World& world_;
+    std::vector<std::pair<Entity, NetEntityId>> changed_;  // Scratch: entities in the current delta
 };
 
 } // namespace city
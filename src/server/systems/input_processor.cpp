@@ -2,11 +2,12 @@
 #include "core/game/components/transform.hpp"
 #include "core/game/components/player.hpp"
 #include "core/game/systems/movement.hpp"
+#include "core/util/job_system.hpp"
 
 namespace city {
 
-InputProcessor::InputProcessor([[maybe_unused]] World& world, TileMap& tilemap)
-    : tilemap_(tilemap) {}
+InputProcessor::InputProcessor([[maybe_unused]] World& world, TileMap& tilemap, JobSystem& jobs)
+    : tilemap_(tilemap), jobs_(jobs) {}
 
 void InputProcessor::set_input(NetEntityId entity, const net::PlayerInputPayload& input) {
     latest_inputs_[entity] = input;
@@ -27,12 +28,37 @@ void InputProcessor::update(World& world, f32 dt) {
         if (!player) continue;
 
         // Apply input using shared system
+        Vec2i previous_direction = player->input_direction;
         MoverSystem::apply_input(*player, {input.move_x, input.move_y});
+        if (player->input_direction != previous_direction) {
+            world.mark_changed<Player>(entity);
+        }
     }
 
     // Update all players' movement using shared system
-    world.each<Transform, Player>([this, dt](Entity, Transform& transform, Player& player) {
+    // (persistent view: cost scales with player count, not with total transforms).
+    // Each entity only touches its own components and reads the tilemap, so entities
+    // are split across the job system.
+    // Only components whose replicated state actually changed are stamped, so idle
+    // players drop out of the delta broadcast (see EntitySync::broadcast).
+    auto& movers = world.view<Transform, Player>();
+    movers.par_each(jobs_, [this, &world, dt](Entity e, Transform& transform, Player& player) {
+        Vec2f position = transform.position;
+        Vec2f velocity = transform.velocity;
+        bool is_moving = player.is_moving;
+        Vec2i grid_pos = player.grid_pos;
+        Vec2i move_target = player.move_target;
+        Vec2i input_direction = player.input_direction;
+
         MoverSystem::update_movement(transform, player, tilemap_, dt);
+
+        if (transform.position != position || transform.velocity != velocity) {
+            world.mark_changed<Transform>(e);
+        }
+        if (player.is_moving != is_moving || player.grid_pos != grid_pos ||
+            player.move_target != move_target || player.input_direction != input_direction) {
+            world.mark_changed<Player>(e);
+        }
     });
 }
 
@@ -11,10 +11,11 @@ namespace city {
 // Forward declarations
 struct Transform;
 struct Player;
+class JobSystem;
 
 class InputProcessor {
 public:
-    InputProcessor(World& world, TileMap& tilemap);
+    InputProcessor(World& world, TileMap& tilemap, JobSystem& jobs);
 
     // Set the latest input from a client (replaces any previous unprocessed input)
     void set_input(NetEntityId entity, const net::PlayerInputPayload& input);
@@ -24,6 +25,7 @@ public:
 
 private:
     TileMap& tilemap_;
+    JobSystem& jobs_;
     std::unordered_map<NetEntityId, std::optional<net::PlayerInputPayload>> latest_inputs_;
 };
 
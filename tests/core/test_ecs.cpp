@@ -1,5 +1,9 @@
 #include <gtest/gtest.h>
 #include "core/ecs/world.hpp"
+#include "core/ecs/command_buffer.hpp"
+#include "core/game/components/transform.hpp"
+#include "core/util/job_system.hpp"
+#include <algorithm>
 
 using namespace city;
 
@@ -108,6 +112,69 @@ TEST(ECS, NetworkId) {
     EXPECT_EQ(world.get_by_net_id(net_id), e);
 }
 
+TEST(ECS, NetworkIdRecycling) {
+    World world;
+    Entity e1 = world.create();
+    NetEntityId id1 = world.allocate_net_id();
+    world.assign_net_id(e1, id1);
+
+    // Destroying releases the slot; the next allocation reuses it with a new generation
+    world.destroy(e1);
+    EXPECT_EQ(world.get_by_net_id(id1), Entity::null());
+
+    Entity e2 = world.create();
+    NetEntityId id2 = world.allocate_net_id();
+    world.assign_net_id(e2, id2);
+    EXPECT_EQ(net_id_slot(id2), net_id_slot(id1));
+    EXPECT_NE(id2, id1);
+    EXPECT_EQ(world.get_by_net_id(id2), e2);
+    EXPECT_EQ(world.get_by_net_id(id1), Entity::null());
+
+    // Client side: IDs come from the server and may be sparse
+    World client;
+    Entity remote = client.create();
+    NetEntityId server_id = make_net_id(500, 3);
+    client.assign_net_id(remote, server_id);
+    EXPECT_EQ(client.get_by_net_id(server_id), remote);
+    EXPECT_EQ(client.get_net_id(remote), server_id);
+    EXPECT_EQ(client.get_by_net_id(make_net_id(500, 2)), Entity::null());
+}
+
+TEST(ECS, NetworkIdReassignment) {
+    World world;
+    std::vector<Entity> entities = world.create_many(8);
+    std::vector<NetEntityId> allocated;
+    for (int i = 0; i < 4; ++i) allocated.push_back(world.allocate_net_id());
+
+    // Assign, release and reassign the same IDs over and over, allocated and remote alike
+    for (int round = 0; round < 100; ++round) {
+        for (size_t i = 0; i < entities.size(); ++i) {
+            NetEntityId id = i < allocated.size() ? allocated[i]
+                                                  : make_net_id(static_cast<u32>(100 + i), 1);
+            world.assign_net_id(entities[(i + round) % entities.size()], id);
+        }
+        for (Entity e : entities) {
+            world.assign_net_id(e, INVALID_NET_ENTITY_ID);   // Releases the mapping
+        }
+    }
+    for (size_t i = 0; i < 2; ++i) world.assign_net_id(entities[i], allocated[i]);
+
+    // Each free allocated slot comes back once; held and remote slots never do
+    std::vector<NetEntityId> fresh;
+    for (int i = 0; i < 6; ++i) fresh.push_back(world.allocate_net_id());
+    std::vector<u32> slots;
+    for (NetEntityId id : fresh) slots.push_back(net_id_slot(id));
+    std::sort(slots.begin(), slots.end());
+    EXPECT_EQ(std::unique(slots.begin(), slots.end()), slots.end());
+    for (u32 slot : slots) {
+        EXPECT_NE(slot, net_id_slot(allocated[0]));
+        EXPECT_NE(slot, net_id_slot(allocated[1]));
+        EXPECT_TRUE(slot < 100 || slot >= 108);
+    }
+    EXPECT_EQ(std::count(slots.begin(), slots.end(), net_id_slot(allocated[2])), 1);
+    EXPECT_EQ(std::count(slots.begin(), slots.end(), net_id_slot(allocated[3])), 1);
+}
+
 TEST(ECS, EachIteration) {
     World world;
 
@@ -132,3 +199,592 @@ TEST(ECS, EachIteration) {
     EXPECT_EQ(count, 2);
     EXPECT_EQ(sum, 3);
 }
+
+TEST(ECS, ComponentRegistryIds) {
+    ComponentTypeId test_id = component_type_id<TestComponent>();
+    ComponentTypeId other_id = component_type_id<OtherComponent>();
+
+    EXPECT_NE(test_id, other_id);
+    EXPECT_EQ(test_id, component_type_id<TestComponent>());
+    EXPECT_LT(test_id, ComponentRegistry::count());
+    EXPECT_LT(other_id, ComponentRegistry::count());
+
+    const auto& info = ComponentRegistry::info<OtherComponent>();
+    EXPECT_EQ(info.id, other_id);
+    EXPECT_EQ(info.size, sizeof(OtherComponent));
+    EXPECT_EQ(info.name, "OtherComponent");
+    EXPECT_FALSE(info.is_serializable());
+}
+
+TEST(ECS, ComponentRegistrySerializeHooks) {
+    World world;
+    Entity e = world.create();
+    world.add_component<Transform>(e, Transform{.position = {3.0f, 4.0f}});
+
+    // Serialize through the type-erased pool + registry metadata only
+    ComponentTypeId id = component_type_id<Transform>();
+    const auto& info = ComponentRegistry::info(id);
+    ASSERT_TRUE(info.is_serializable());
+
+    const IComponentPool* pool = world.get_pool(id);
+    ASSERT_NE(pool, nullptr);
+    Serializer s;
+    info.serialize(pool->get_erased(e.index), s);
+
+    Transform restored;
+    Deserializer d(s.data());
+    info.deserialize(&restored, d);
+    EXPECT_FLOAT_EQ(restored.position.x, 3.0f);
+    EXPECT_FLOAT_EQ(restored.position.y, 4.0f);
+}
+
+TEST(ECS, DestroyRemovesComponents) {
+    World world;
+    Entity e = world.create();
+    world.add_component<TestComponent>(e, {42});
+    world.add_component<OtherComponent>(e, {1.0f, 2.0f});
+
+    world.destroy(e);
+    EXPECT_EQ(world.get_pool<TestComponent>()->size(), 0u);
+    EXPECT_EQ(world.get_pool<OtherComponent>()->size(), 0u);
+
+    // A recycled slot must not inherit the previous owner's components
+    Entity reused = world.create();
+    ASSERT_EQ(reused.index, e.index);
+    EXPECT_FALSE(world.has_component<TestComponent>(reused));
+}
+
+TEST(ECS, PoolSizesStayFlatOverChurn) {
+    World world;
+
+    // A few long-lived entities so the pools are never trivially empty
+    for (int i = 0; i < 8; ++i) {
+        Entity e = world.create();
+        world.add_component<TestComponent>(e, {i});
+    }
+
+    auto cycle = [&world](int i) {
+        Entity e = world.create();
+        world.add_component<TestComponent>(e, {i});
+        world.add_component<OtherComponent>(e, {0.0f, 0.0f});
+        world.destroy(e);
+    };
+
+    for (int i = 0; i < 1000; ++i) cycle(i);
+    size_t warm_memory = world.component_memory_usage();
+
+    for (int i = 0; i < 1'000'000; ++i) cycle(i);
+
+    EXPECT_EQ(world.entity_count(), 8u);
+    EXPECT_EQ(world.get_pool<TestComponent>()->size(), 8u);
+    EXPECT_EQ(world.get_pool<OtherComponent>()->size(), 0u);
+    EXPECT_EQ(world.component_memory_usage(), warm_memory);
+}
+
+TEST(ECS, SparsePagesFollowComponents) {
+    ComponentPool<TestComponent> pool;
+    constexpr u32 page = ComponentPool<TestComponent>::PAGE_SIZE;
+
+    // A single component at a high index allocates one page, not the whole range
+    pool.set(500'000, {1});
+    EXPECT_EQ(pool.memory_stats().sparse_pages, 1u);
+    EXPECT_LT(pool.memory_stats().sparse_bytes, 2 * page * sizeof(u32));
+    EXPECT_FALSE(pool.has(500'001));
+    EXPECT_FALSE(pool.has(7));
+
+    // Swap-remove across pages keeps lookups right
+    pool.set(3, {2});
+    pool.set(page * 2 + 5, {3});
+    EXPECT_EQ(pool.memory_stats().sparse_pages, 3u);
+    pool.remove(3);
+    EXPECT_EQ(pool.get(500'000)->value, 1);
+    EXPECT_EQ(pool.get(page * 2 + 5)->value, 3);
+
+    // Emptied pages are freed
+    EXPECT_EQ(pool.memory_stats().sparse_pages, 2u);
+    pool.remove(500'000);
+    pool.remove(page * 2 + 5);
+    EXPECT_EQ(pool.memory_stats().sparse_pages, 0u);
+    EXPECT_TRUE(pool.empty());
+
+    World world;
+    Entity e = world.create();
+    world.add_component<TestComponent>(e, {1});
+    auto report = world.component_memory_report();
+    ASSERT_EQ(report.size(), 1u);
+    EXPECT_EQ(report[0].name, "TestComponent");
+    EXPECT_EQ(report[0].stats.component_count, 1u);
+}
+
+TEST(ECS, EachDrivenBySmallestPool) {
+    World world;
+
+    // Many TestComponents, few OtherComponents - results must not depend on driver choice
+    Entity both{};
+    for (int i = 0; i < 100; ++i) {
+        Entity e = world.create();
+        world.add_component<TestComponent>(e, {i});
+        if (i == 42) {
+            world.add_component<OtherComponent>(e, {4.0f, 2.0f});
+            both = e;
+        }
+    }
+
+    int count = 0;
+    world.each<TestComponent, OtherComponent>([&](Entity e, TestComponent& tc, OtherComponent& oc) {
+        EXPECT_EQ(e, both);
+        EXPECT_EQ(tc.value, 42);
+        EXPECT_FLOAT_EQ(oc.x, 4.0f);
+        ++count;
+    });
+    EXPECT_EQ(count, 1);
+}
+
+TEST(ECS, ViewTracksAddRemoveDestroy) {
+    World world;
+    Entity e1 = world.create();
+    Entity e2 = world.create();
+    world.add_component<TestComponent>(e1, {1});
+    world.add_component<OtherComponent>(e1, {0.0f, 0.0f});
+
+    // View picks up existing matches on creation
+    auto& view = world.view<TestComponent, OtherComponent>();
+    EXPECT_EQ(view.size(), 1u);
+    EXPECT_EQ(&view, (&world.view<TestComponent, OtherComponent>()));
+
+    world.add_component<TestComponent>(e2, {2});
+    EXPECT_EQ(view.size(), 1u);
+    world.add_component<OtherComponent>(e2, {0.0f, 0.0f});
+    EXPECT_EQ(view.size(), 2u);
+
+    world.remove_component<OtherComponent>(e1);
+    EXPECT_EQ(view.size(), 1u);
+    EXPECT_FALSE(view.contains(e1.index));
+
+    int sum = 0;
+    view.each([&sum](Entity, TestComponent& tc, OtherComponent&) { sum += tc.value; });
+    EXPECT_EQ(sum, 2);
+
+    world.destroy(e2);
+    EXPECT_TRUE(view.empty());
+}
+
+TEST(ECS, ChangeTicksTrackWrites) {
+    World world;
+    Entity e1 = world.create();
+    Entity e2 = world.create();
+
+    world.set_change_tick(1);
+    world.add_component<TestComponent>(e1, {1});
+    world.add_component<TestComponent>(e2, {2});
+    world.add_component<OtherComponent>(e2, {0.0f, 0.0f});
+    EXPECT_EQ(world.changed_tick<TestComponent>(e1), 1u);
+
+    // Plain reads don't stamp; get_mut and mark_changed do
+    world.set_change_tick(5);
+    EXPECT_EQ(world.get_component<TestComponent>(e1)->value, 1);
+    world.get_mut<TestComponent>(e2)->value = 20;
+    EXPECT_EQ(world.changed_tick<TestComponent>(e1), 1u);
+    EXPECT_EQ(world.changed_tick<TestComponent>(e2), 5u);
+
+    std::vector<Entity> changed;
+    world.each_changed_since<TestComponent>(5, [&](Entity e, TestComponent&) {
+        changed.push_back(e);
+    });
+    ASSERT_EQ(changed.size(), 1u);
+    EXPECT_EQ(changed[0], e2);
+
+    // each_mut stamps every visited component
+    world.set_change_tick(7);
+    world.each_mut<TestComponent, OtherComponent>([](Entity, TestComponent& tc, OtherComponent&) {
+        tc.value += 1;
+    });
+    EXPECT_EQ(world.changed_tick<TestComponent>(e2), 7u);
+    EXPECT_EQ(world.changed_tick<OtherComponent>(e2), 7u);
+    EXPECT_EQ(world.changed_tick<TestComponent>(e1), 1u);
+
+    world.set_change_tick(9);
+    world.mark_changed<TestComponent>(e1);
+    int count = 0;
+    world.each_changed_since<TestComponent>(8, [&count](Entity, TestComponent&) { ++count; });
+    EXPECT_EQ(count, 1);
+    world.each_changed_since<TestComponent>(0, [&count](Entity, TestComponent&) { ++count; });
+    EXPECT_EQ(count, 3);
+}
+
+TEST(ECS, SnapshotRestore) {
+    World world;
+    auto& view = world.view<TestComponent, OtherComponent>();
+
+    Entity a = world.create();
+    Entity b = world.create();
+    world.add_component<TestComponent>(a, {1});
+    world.add_component<OtherComponent>(a, {1.0f, 2.0f});
+    world.add_component<TestComponent>(b, {2});
+    world.assign_net_id(a, world.allocate_net_id());
+    NetEntityId a_net = world.get_net_id(a);
+
+    WorldSnapshot snapshot;
+    EXPECT_TRUE(snapshot.empty());
+    world.save_snapshot(snapshot);
+    EXPECT_FALSE(snapshot.empty());
+
+    // Mutate everything the snapshot covers
+    world.get_component<TestComponent>(a)->value = 100;
+    world.destroy(a);
+    world.add_component<OtherComponent>(b, {3.0f, 4.0f});
+    Entity c = world.create();
+    world.add_component<TestComponent>(c, {3});
+    world.assign_net_id(c, world.allocate_net_id());
+    EXPECT_EQ(view.size(), 1u);
+
+    world.restore_snapshot(snapshot);
+    EXPECT_EQ(world.entity_count(), 2u);
+    EXPECT_TRUE(world.is_alive(a));
+    EXPECT_FALSE(world.is_alive(c));
+    EXPECT_EQ(world.get_component<TestComponent>(a)->value, 1);
+    EXPECT_FALSE(world.has_component<OtherComponent>(b));
+    EXPECT_EQ(world.get_by_net_id(a_net), a);
+    EXPECT_EQ(view.size(), 1u);
+    EXPECT_TRUE(view.contains(a.index));
+
+    // The snapshot is reusable: resimulate and restore again
+    world.get_component<TestComponent>(b)->value = 50;
+    world.restore_snapshot(snapshot);
+    EXPECT_EQ(world.get_component<TestComponent>(b)->value, 2);
+}
+
+TEST(ECS, ComponentSignals) {
+    World world;
+    std::vector<Entity> constructed;
+    int updates = 0;
+    int destroyed_value = 0;
+
+    world.on_construct<TestComponent>().connect([&](World&, Entity e) { constructed.push_back(e); });
+    world.on_update<TestComponent>().connect([&](World&, Entity) { ++updates; });
+    // Destroy handlers can still read the component
+    world.on_destroy<TestComponent>().connect([&](World& w, Entity e) {
+        destroyed_value += w.get_component<TestComponent>(e)->value;
+    });
+
+    std::vector<Entity> batch;
+    int batches = 0;
+    auto id = world.on_update<TestComponent>().connect_deferred(
+        [&](World&, std::span<const Entity> entities) {
+            batch.assign(entities.begin(), entities.end());
+            ++batches;
+        });
+
+    Entity a = world.create();
+    Entity b = world.create();
+    world.add_component<TestComponent>(a, {1});
+    world.add_component<TestComponent>(b, {2});
+    world.add_component<OtherComponent>(b, {0.0f, 0.0f});
+    EXPECT_EQ(constructed.size(), 2u);
+
+    world.add_component<TestComponent>(a, {10});    // Replace counts as update
+    world.get_mut<TestComponent>(b)->value = 20;
+    world.mark_changed<TestComponent>(b);
+    world.get_component<TestComponent>(a);          // Plain reads don't fire
+    EXPECT_EQ(updates, 3);
+
+    // Deferred subscribers get each entity once per dispatch
+    EXPECT_EQ(batches, 0);
+    world.dispatch_signals();
+    EXPECT_EQ(batches, 1);
+    ASSERT_EQ(batch.size(), 2u);
+    EXPECT_EQ(batch[0], a);
+    EXPECT_EQ(batch[1], b);
+    world.dispatch_signals();
+    EXPECT_EQ(batches, 1);
+
+    world.remove_component<TestComponent>(a);
+    world.destroy(b);
+    EXPECT_EQ(destroyed_value, 30);
+
+    world.on_update<TestComponent>().disconnect(id);
+    world.add_component<TestComponent>(a, {1});
+    world.mark_changed<TestComponent>(a);
+    world.dispatch_signals();
+    EXPECT_EQ(batches, 1);
+}
+
+TEST(ECS, SignalHandlersDisconnectThemselves) {
+    World world;
+    auto& construct = world.on_construct<TestComponent>();
+    auto& update = world.on_update<TestComponent>();
+
+    // One-shot handlers: each drops itself on first call and connects a follow-up
+    int once = 0;
+    int follow_ups = 0;
+    ComponentSignal::ConnectionId once_id = 0;
+    once_id = construct.connect([&](World&, Entity) {
+        ++once;
+        construct.disconnect(once_id);
+        construct.connect([&](World&, Entity) { ++follow_ups; });
+    });
+
+    int batches = 0;
+    ComponentSignal::ConnectionId batch_id = 0;
+    batch_id = update.connect_deferred([&](World&, std::span<const Entity>) {
+        ++batches;
+        update.disconnect(batch_id);
+    });
+
+    Entity a = world.create();
+    Entity b = world.create();
+    world.add_component<TestComponent>(a, {1});
+    EXPECT_EQ(once, 1);
+    EXPECT_EQ(follow_ups, 0);     // Connected while firing: not called for that event
+    world.add_component<TestComponent>(b, {2});
+    EXPECT_EQ(once, 1);
+    EXPECT_EQ(follow_ups, 1);
+
+    world.mark_changed<TestComponent>(a);
+    world.dispatch_signals();
+    world.mark_changed<TestComponent>(a);
+    world.dispatch_signals();
+    EXPECT_EQ(batches, 1);
+    EXPECT_TRUE(update.empty());
+}
+
+TEST(ECS, DeferredSignalsFromWorkers) {
+    World world;
+    JobSystem jobs(3);
+    std::vector<Entity> batch;
+    world.on_update<TestComponent>().connect_deferred(
+        [&](World&, std::span<const Entity> entities) {
+            batch.assign(entities.begin(), entities.end());
+        });
+
+    std::vector<Entity> entities = world.create_many(5000);
+    world.add_components_bulk<TestComponent>(entities);
+    world.dispatch_signals();
+    batch.clear();
+
+    // Every worker queues its own events; each entity arrives once, in order
+    for (int round = 0; round < 2; ++round) {
+        jobs.parallel_for(entities.size(), 64, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                world.mark_changed<TestComponent>(entities[i]);
+                if (i % 3 == 0) world.mark_changed<TestComponent>(entities[i]);
+            }
+        });
+    }
+    world.dispatch_signals();
+    EXPECT_EQ(batch, entities);
+}
+
+TEST(ECS, BulkCreateAddDestroy) {
+    World world;
+    auto& view = world.view<TestComponent, OtherComponent>();
+
+    std::vector<Entity> entities = world.create_many(1000);
+    EXPECT_EQ(world.entity_count(), 1000u);
+
+    std::vector<TestComponent> values(entities.size());
+    for (size_t i = 0; i < values.size(); ++i) values[i].value = static_cast<int>(i);
+    world.add_components_bulk<TestComponent>(entities, values);
+    world.add_components_bulk<OtherComponent>(std::span(entities).first(10), {1.0f, 1.0f});
+    world.assign_new_net_ids(entities);
+
+    EXPECT_EQ(world.get_component<TestComponent>(entities[42])->value, 42);
+    EXPECT_EQ(view.size(), 10u);
+    EXPECT_EQ(world.get_by_net_id(world.get_net_id(entities[999])), entities[999]);
+
+    // Duplicates and dead handles are ignored
+    std::vector<Entity> doomed(entities.begin(), entities.begin() + 500);
+    doomed.push_back(entities[0]);
+    doomed.push_back(Entity{entities[1].index, entities[1].generation + 1});
+    NetEntityId doomed_net = world.get_net_id(entities[3]);
+    world.destroy_many(doomed);
+
+    EXPECT_EQ(world.entity_count(), 500u);
+    EXPECT_FALSE(world.is_alive(entities[0]));
+    EXPECT_TRUE(world.is_alive(entities[500]));
+    EXPECT_EQ(world.get_pool<TestComponent>()->size(), 500u);
+    EXPECT_TRUE(view.empty());
+    EXPECT_EQ(world.get_by_net_id(doomed_net), Entity::null());
+
+    // Freed slots are reused by the next batch
+    std::vector<Entity> reborn = world.create_many(500);
+    EXPECT_EQ(world.entity_count(), 1000u);
+    for (Entity e : reborn) {
+        EXPECT_LT(e.index, 1000u);
+        EXPECT_FALSE(world.has_component<TestComponent>(e));
+    }
+}
+
+namespace {
+
+template<typename Writes, typename Reads>
+class AccessSystem : public System {
+public:
+    explicit AccessSystem(int& runs) : runs_(runs) {}
+    void update(World&, f32) override { ++runs_; }
+    SystemAccess access() const override {
+        return SystemAccess{}.write<Writes>().template read<Reads>();
+    }
+    std::string_view name() const override { return "access_system"; }
+
+private:
+    int& runs_;
+};
+
+class LegacySystem : public System {
+public:
+    void update(World&, f32) override {}
+    std::string_view name() const override { return "legacy_system"; }
+};
+
+} // namespace
+
+TEST(ECS, SchedulerStagesByAccess) {
+    World world;
+    int a_runs = 0, b_runs = 0, c_runs = 0;
+
+    // a and b touch disjoint components -> same stage; c reads what a writes -> after a
+    world.add_system<AccessSystem<TestComponent, Transform>>(a_runs);
+    world.add_system<AccessSystem<OtherComponent, Transform>>(b_runs);
+    world.add_system<AccessSystem<Transform, TestComponent>>(c_runs);
+    world.add_system<LegacySystem>();
+
+    JobSystem jobs(2);
+    world.set_job_system(&jobs);
+    world.update(0.016f);
+
+    EXPECT_EQ(a_runs, 1);
+    EXPECT_EQ(b_runs, 1);
+    EXPECT_EQ(c_runs, 1);
+
+    const auto& timings = world.system_timings();
+    ASSERT_EQ(timings.size(), 4u);
+    EXPECT_EQ(timings[0].stage, 0u);
+    EXPECT_EQ(timings[1].stage, 0u);
+    EXPECT_EQ(timings[2].stage, 1u);
+    EXPECT_EQ(timings[3].stage, 2u);  // No declared access -> runs alone, after everything
+    EXPECT_EQ(timings[0].name, "access_system");
+}
+
+TEST(ECS, CommandBufferDefersStructuralChanges) {
+    World world;
+    std::vector<Entity> entities;
+    for (int i = 0; i < 10; ++i) {
+        Entity e = world.create();
+        world.add_component<TestComponent>(e, {i});
+        entities.push_back(e);
+    }
+
+    // Destroy odd entities and tag even ones while iterating
+    world.each<TestComponent>([&world](Entity e, TestComponent& tc) {
+        if (tc.value % 2 == 1) {
+            world.commands().destroy(e);
+            world.commands().add_component<OtherComponent>(e, {1.0f, 1.0f});  // Skipped
+        } else {
+            world.commands().add_component<OtherComponent>(e, {0.0f, 0.0f});
+        }
+    });
+    EXPECT_EQ(world.entity_count(), 10u);
+
+    auto& commands = world.commands();
+    PendingEntity spawned = commands.create();
+    commands.add_component<TestComponent>(spawned, {100});
+    commands.add_component<TestComponent>(spawned, {200});  // Last write wins
+
+    world.flush_commands();
+
+    EXPECT_EQ(world.entity_count(), 6u);
+    EXPECT_EQ(world.get_pool<OtherComponent>()->size(), 5u);
+    EXPECT_FALSE(world.is_alive(entities[1]));
+    EXPECT_TRUE(world.has_component<OtherComponent>(entities[2]));
+
+    int found = 0;
+    world.each<TestComponent>([&found](Entity, TestComponent& tc) {
+        if (tc.value == 200) ++found;
+    });
+    EXPECT_EQ(found, 1);
+    EXPECT_TRUE(world.commands().empty());
+}
+
+TEST(ECS, CommandBufferFromWorkers) {
+    World world;
+    for (int i = 0; i < 1000; ++i) {
+        Entity e = world.create();
+        world.add_component<TestComponent>(e, {i});
+    }
+
+    JobSystem jobs(3);
+    world.par_each<TestComponent>(jobs, [&world](Entity e, TestComponent& tc) {
+        if (tc.value % 10 == 0) {
+            world.commands().remove_component<TestComponent>(e);
+        }
+    }, 16);
+    world.flush_commands();
+
+    EXPECT_EQ(world.get_pool<TestComponent>()->size(), 900u);
+}
+
+TEST(ECS, CommandBufferRecordsFromFlushSignals) {
+    World world;
+    std::vector<Entity> sources = world.create_many(64);
+    std::vector<Entity> echoes = world.create_many(64);
+    std::vector<Entity> victims = world.create_many(64);
+
+    // Handlers fired by a flush record into fresh buffers; their commands wait for the next one
+    world.on_construct<TestComponent>().connect([&](World& w, Entity e) {
+        int value = w.get_component<TestComponent>(e)->value;
+        if (value >= 1000) return;
+        auto i = static_cast<size_t>(value);
+        w.commands().add_component<TestComponent>(echoes[i], {value + 1000});
+        w.commands().destroy(victims[i]);
+    });
+
+    for (size_t i = 0; i < sources.size(); ++i) {
+        world.commands().add_component<TestComponent>(sources[i], {static_cast<int>(i)});
+    }
+    world.flush_commands();
+
+    EXPECT_EQ(world.get_pool<TestComponent>()->size(), 64u);
+    EXPECT_EQ(world.entity_count(), 192u);
+    EXPECT_FALSE(world.commands().empty());
+
+    world.flush_commands();
+
+    EXPECT_EQ(world.get_pool<TestComponent>()->size(), 128u);
+    EXPECT_EQ(world.entity_count(), 128u);
+    EXPECT_EQ(world.get_component<TestComponent>(echoes[5])->value, 1005);
+    EXPECT_FALSE(world.is_alive(victims[5]));
+    EXPECT_TRUE(world.commands().empty());
+}
+
+TEST(ECS, CommandBufferKeepsRecordingOrderPerComponent) {
+    World world;
+    Entity reset = world.create();
+    Entity dropped = world.create();
+    Entity readded = world.create();
+    world.add_component<TestComponent>(reset, {1});
+    world.add_component<TestComponent>(readded, {3});
+
+    int destroyed = 0;
+    int constructed = 0;
+    world.on_destroy<TestComponent>().connect([&](World&, Entity) { ++destroyed; });
+    world.on_construct<TestComponent>().connect([&](World&, Entity) { ++constructed; });
+
+    auto& commands = world.commands();
+    commands.remove_component<TestComponent>(reset);        // Reset: remove, then add
+    commands.add_component<TestComponent>(reset, {10});
+    commands.add_component<TestComponent>(dropped, {20});   // Add, then remove: gone
+    commands.remove_component<TestComponent>(dropped);
+    commands.add_component<TestComponent>(readded, {30});   // Add, remove, add again
+    commands.remove_component<TestComponent>(readded);
+    commands.add_component<TestComponent>(readded, {31});
+    world.flush_commands();
+
+    ASSERT_TRUE(world.has_component<TestComponent>(reset));
+    EXPECT_EQ(world.get_component<TestComponent>(reset)->value, 10);
+    EXPECT_FALSE(world.has_component<TestComponent>(dropped));
+    ASSERT_TRUE(world.has_component<TestComponent>(readded));
+    EXPECT_EQ(world.get_component<TestComponent>(readded)->value, 31);
+    EXPECT_EQ(destroyed, 2);
+    EXPECT_EQ(constructed, 2);
+}
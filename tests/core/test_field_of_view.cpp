@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include "core/grid/field_of_view.hpp"
+#include "test_maps.hpp"
+#include <random>
+
+using namespace city;
+using namespace city::test;
+
+TEST(FieldOfView, OpenRoom) {
+    TileMap map = make_map(32, 32);
+    FieldOfView fov;
+    fov.compute(map, {16, 16}, 5);
+
+    // Everything within Euclidean distance 5
+    size_t expected = 0;
+    for (i32 y = -6; y <= 6; ++y) {
+        for (i32 x = -6; x <= 6; ++x) {
+            bool inside = x * x + y * y <= 25;
+            expected += inside;
+            EXPECT_EQ(fov.is_visible({16 + x, 16 + y}), inside) << x << "," << y;
+        }
+    }
+    EXPECT_EQ(fov.visible_count(), expected);
+
+    fov.compute(map, {16, 16}, 0);
+    EXPECT_EQ(fov.visible_count(), 1u);
+    EXPECT_TRUE(fov.is_visible({16, 16}));
+}
+
+TEST(FieldOfView, WallsHideWhatIsBehind) {
+    TileMap map = make_map(32, 32);
+    for (i32 y = 10; y <= 20; ++y) map.set_tile({18, y}, wall_tile());
+
+    FieldOfView fov;
+    fov.compute(map, {15, 15}, 8);
+    EXPECT_TRUE(fov.is_visible({17, 15}));
+    EXPECT_TRUE(fov.is_visible({18, 15}));      // The wall itself
+    EXPECT_FALSE(fov.is_visible({19, 15}));
+    EXPECT_FALSE(fov.is_visible({22, 14}));
+    EXPECT_TRUE(fov.is_visible({15, 22}));
+    EXPECT_FALSE(fov.is_visible({40, 15}));     // Outside the radius
+}
+
+TEST(FieldOfView, Symmetric) {
+    constexpr i32 SIZE = 48;
+    TileMap map = make_map(SIZE, SIZE);
+    std::mt19937 rng(4);
+    std::bernoulli_distribution blocked(0.2);
+    for (i32 y = 0; y < SIZE; ++y) {
+        for (i32 x = 0; x < SIZE; ++x) {
+            if (blocked(rng)) map.set_tile({x, y}, wall_tile());
+        }
+    }
+
+    constexpr i32 RADIUS = 10;
+    std::vector<FieldOfView> fovs(static_cast<size_t>(SIZE * SIZE));
+    for (i32 y = 0; y < SIZE; ++y) {
+        for (i32 x = 0; x < SIZE; ++x) {
+            fovs[static_cast<size_t>(y * SIZE + x)].compute(map, {x, y}, RADIUS);
+        }
+    }
+
+    u32 pairs = 0;
+    for (i32 ay = 0; ay < SIZE; ++ay) {
+        for (i32 ax = 0; ax < SIZE; ++ax) {
+            if (map.is_opaque({ax, ay})) continue;
+            const FieldOfView& a = fovs[static_cast<size_t>(ay * SIZE + ax)];
+            for (i32 by = ay - RADIUS; by <= ay + RADIUS; ++by) {
+                for (i32 bx = ax - RADIUS; bx <= ax + RADIUS; ++bx) {
+                    if (bx < 0 || by < 0 || bx >= SIZE || by >= SIZE) continue;
+                    if (map.is_opaque({bx, by})) continue;
+                    const FieldOfView& b = fovs[static_cast<size_t>(by * SIZE + bx)];
+                    ASSERT_EQ(a.is_visible({bx, by}), b.is_visible({ax, ay}))
+                        << ax << "," << ay << " / " << bx << "," << by;
+                    pairs += a.is_visible({bx, by});
+                }
+            }
+        }
+    }
+    EXPECT_GT(pairs, 10000u);
+}
+
+TEST(FieldOfView, Cache) {
+    TileMap map = make_map(128, 128);
+    FieldOfViewCache cache(map, 4);
+
+    const FieldOfView& a = cache.get({20, 20}, 6);
+    EXPECT_EQ(&cache.get({20, 20}, 6), &a);
+    EXPECT_EQ(cache.computed(), 1u);
+    cache.get({20, 20}, 7);
+    EXPECT_EQ(cache.computed(), 2u);
+
+    // A change in a chunk far away keeps the result
+    map.set_tile({100, 100}, wall_tile());
+    EXPECT_TRUE(cache.get({20, 20}, 6).is_visible({23, 20}));
+    EXPECT_EQ(cache.computed(), 2u);
+
+    // A wall next to the viewer recomputes it
+    map.set_tile({22, 20}, wall_tile());
+    EXPECT_FALSE(cache.get({20, 20}, 6).is_visible({23, 20}));
+    EXPECT_EQ(cache.computed(), 3u);
+
+    // Over capacity the least recently used half goes
+    for (i32 i = 0; i < 5; ++i) cache.get({40 + i, 40}, 6);
+    EXPECT_LE(cache.size(), 4u);
+    cache.get({44, 40}, 6);
+    EXPECT_EQ(cache.computed(), 8u);
+}
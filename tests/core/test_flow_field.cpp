@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+#include "core/game/systems/movement.hpp"
+#include "core/grid/flow_field.hpp"
+#include "core/grid/pathfinder.hpp"
+#include "test_maps.hpp"
+#include <random>
+
+using namespace city;
+using namespace city::test;
+
+namespace {
+
+// Follow the direction field from start; returns the cost walked, or UNREACHABLE if it
+// stops short of the goal or takes an illegal step
+u32 walk_field(const TileMap& map, const FlowField& field, TilePos start) {
+    u32 cost = 0;
+    TilePos pos = start;
+    while (pos != field.goal()) {
+        TilePos step = field.direction_at(pos);
+        if (step == TilePos{0, 0}) return FlowField::UNREACHABLE;
+
+        TilePos next = pos + step;
+        if (!map.is_passable(next)) return FlowField::UNREACHABLE;
+        if (step.x != 0 && step.y != 0) {
+            if (!map.is_passable(pos + TilePos{step.x, 0}) ||
+                !map.is_passable(pos + TilePos{0, step.y})) {
+                return FlowField::UNREACHABLE;
+            }
+            cost += 14;
+        } else {
+            cost += 10;
+        }
+        pos = next;
+    }
+    return cost;
+}
+
+// Costs and directions of every tile of two fields agree
+void expect_same_field(const FlowField& a, const FlowField& b, i32 size) {
+    for (i32 y = 0; y < size; ++y) {
+        for (i32 x = 0; x < size; ++x) {
+            ASSERT_EQ(a.cost_at({x, y}), b.cost_at({x, y})) << x << "," << y;
+            ASSERT_EQ(a.direction_at({x, y}), b.direction_at({x, y})) << x << "," << y;
+        }
+    }
+}
+
+} // namespace
+
+TEST(FlowField, MatchesShortestPaths) {
+    constexpr i32 SIZE = 70;
+    TileMap map = make_random_map(SIZE, 5, 0.3);
+    map.set_tile({35, 35}, floor_tile());
+    FlowField field(map, {35, 35});
+    Pathfinder pathfinder(map);
+
+    std::vector<TilePos> path;
+    u32 reachable = 0;
+    for (i32 y = 0; y < SIZE; ++y) {
+        for (i32 x = 0; x < SIZE; ++x) {
+            bool found = pathfinder.find_path({x, y}, {35, 35}, path);
+            if (!found) {
+                EXPECT_EQ(field.cost_at({x, y}), FlowField::UNREACHABLE);
+                EXPECT_EQ(field.direction_at({x, y}), TilePos(0, 0));
+                continue;
+            }
+
+            ++reachable;
+            u32 cost = field.cost_at({x, y});
+            EXPECT_EQ(walk_field(map, field, {x, y}), cost);
+            u32 path_cost = 0;
+            for (size_t i = 1; i < path.size(); ++i) {
+                TilePos step = path[i] - path[i - 1];
+                path_cost += (step.x != 0 && step.y != 0) ? 14 : 10;
+            }
+            EXPECT_EQ(cost, path_cost);
+        }
+    }
+    EXPECT_GT(reachable, 1000u);
+    EXPECT_EQ(field.cost_at({35, 35}), 0u);
+    EXPECT_EQ(field.cost_at({-1, 3}), FlowField::UNREACHABLE);
+}
+
+TEST(FlowField, IncrementalMatchesRebuild) {
+    constexpr i32 SIZE = 64;
+    TileMap map = make_random_map(SIZE, 11, 0.2);
+    TilePos goal{20, 40};
+    map.set_tile(goal, floor_tile());
+    FlowField field(map, goal);
+    EXPECT_EQ(field.last_rebuilt_chunks(), 16u);
+
+    // Random walls and floors, including blocking and reopening the goal itself
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<i32> coord(0, SIZE - 1);
+    std::bernoulli_distribution blocked(0.5);
+    for (int round = 0; round < 40; ++round) {
+        for (int i = 0; i < 1 + round % 5; ++i) {
+            map.set_tile({coord(rng), coord(rng)}, blocked(rng) ? wall_tile() : floor_tile());
+        }
+        if (round == 20) map.set_tile(goal, wall_tile());
+        if (round == 25) map.set_tile(goal, floor_tile());
+
+        field.update();
+        FlowField fresh(map, goal);
+        expect_same_field(field, fresh, SIZE);
+    }
+}
+
+TEST(FlowField, EditsRebuildNearbyChunks) {
+    TileMap map;
+    map.set_bounds(128, 128);
+    for (i32 y = 0; y < 128; ++y) {
+        for (i32 x = 0; x < 128; ++x) map.set_tile({x, y}, floor_tile());
+    }
+    // Enclosed room in chunk (6, 6): its tiles are unreachable either way
+    for (i32 i = 98; i < 110; ++i) {
+        map.set_tile({i, 98}, wall_tile());
+        map.set_tile({i, 109}, wall_tile());
+        map.set_tile({98, i}, wall_tile());
+        map.set_tile({109, i}, wall_tile());
+    }
+    FlowField field(map, {2, 2});
+    EXPECT_EQ(field.cost_at({104, 104}), FlowField::UNREACHABLE);
+
+    map.set_tile({104, 104}, wall_tile());
+    field.update();
+    EXPECT_EQ(field.last_rebuilt_chunks(), 1u);
+
+    // Unchanged version: nothing to do
+    field.update();
+    EXPECT_EQ(field.last_rebuilt_chunks(), 0u);
+
+    // A door into the room makes it reachable
+    map.set_tile({98, 104}, floor_tile());
+    field.update();
+    EXPECT_NE(field.cost_at({100, 100}), FlowField::UNREACHABLE);
+    EXPECT_EQ(walk_field(map, field, {100, 100}), field.cost_at({100, 100}));
+}
+
+TEST(FlowField, Cache) {
+    TileMap map = make_random_map(32, 1, 0.0);
+    FlowFieldCache cache(map, 2);
+
+    auto a = cache.get({1, 1});
+    EXPECT_EQ(cache.get({1, 1}), a);
+    auto b = cache.get({5, 5});
+    cache.get({1, 1});
+    EXPECT_EQ(cache.size(), 2u);
+
+    // {5, 5} was used least recently and makes room for {9, 9}
+    auto c = cache.get({9, 9});
+    EXPECT_EQ(c->goal(), TilePos(9, 9));
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_EQ(cache.get({1, 1}), a);
+    EXPECT_NE(cache.get({5, 5}), b);
+
+    // An evicted field stays usable by whoever still holds it
+    EXPECT_EQ(b->goal(), TilePos(5, 5));
+    EXPECT_EQ(b->cost_at({5, 5}), 0u);
+
+    // Fields handed out are brought up to date on the next get
+    map.set_tile({2, 1}, wall_tile());
+    EXPECT_EQ(cache.get({1, 1})->cost_at({2, 1}), FlowField::UNREACHABLE);
+}
+
+TEST(FlowField, SteersMovers) {
+    TileMap map;
+    map.set_bounds(40, 40);
+    for (i32 y = 0; y < 40; ++y) {
+        for (i32 x = 0; x < 40; ++x) {
+            bool wall = x == 20 && y != 30;
+            map.set_tile({x, y}, wall ? wall_tile() : floor_tile());
+        }
+    }
+    FlowField field(map, {35, 5});
+
+    std::vector<Transform> transforms(20);
+    std::vector<Player> players(20);
+    for (size_t i = 0; i < transforms.size(); ++i) {
+        transforms[i].position = {2.5f + static_cast<f32>(i % 5), 2.5f + static_cast<f32>(i)};
+        if (i % 2) players[i].movement_mode = MovementMode::Free;
+    }
+
+    for (int tick = 0; tick < 60 * 20; ++tick) {
+        for (size_t i = 0; i < transforms.size(); ++i) {
+            MoverSystem::steer_by_flow_field(players[i], transforms[i], field);
+            MoverSystem::update_movement(transforms[i], players[i], map, 1.0f / 60.0f);
+        }
+    }
+
+    for (size_t i = 0; i < transforms.size(); ++i) {
+        EXPECT_EQ(players[i].grid_pos, Vec2i(35, 5)) << i;
+        EXPECT_FALSE(players[i].is_moving) << i;
+        EXPECT_EQ(players[i].input_direction, Vec2i(0, 0)) << i;
+    }
+}
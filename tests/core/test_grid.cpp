@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "core/grid/tilemap.hpp"
+#include <random>
 
 using namespace city;
 
@@ -123,6 +124,45 @@ TEST(Grid, LineOfSight) {
     EXPECT_EQ(line.back(), TilePos(3, 2));
 }
 
+TEST(Grid, LineOfSightMatchesLine) {
+    Tile floor;
+    floor.floor_id = 1;
+    Tile wall = floor;
+    wall.flags = TileFlags::Solid | TileFlags::Opaque;
+
+    // Unbounded map across negative chunks, with a hole of missing chunks
+    TileMap map;
+    std::mt19937 rng(9);
+    std::bernoulli_distribution blocked(0.1);
+    for (i32 y = -40; y < 40; ++y) {
+        for (i32 x = -40; x < 40; ++x) {
+            if (x >= 16 && x < 32 && y >= -16 && y < 0) continue;
+            map.set_tile({x, y}, blocked(rng) ? wall : floor);
+        }
+    }
+
+    // Reference: every tile strictly between the endpoints is transparent
+    auto reference = [&map](TilePos from, TilePos to) {
+        auto line = TileMap::get_line(from, to);
+        for (size_t i = 1; i + 1 < line.size(); ++i) {
+            if (map.is_opaque(line[i])) return false;
+        }
+        return true;
+    };
+
+    std::uniform_int_distribution<i32> coord(-45, 44);
+    u32 visible = 0;
+    for (int i = 0; i < 2000; ++i) {
+        TilePos from{coord(rng), coord(rng)};
+        TilePos to{coord(rng), coord(rng)};
+        bool expected = reference(from, to);
+        EXPECT_EQ(map.has_line_of_sight(from, to), expected) << i;
+        visible += expected;
+    }
+    EXPECT_GT(visible, 100u);
+    EXPECT_TRUE(map.has_line_of_sight({3, 3}, {3, 3}));
+}
+
 TEST(Grid, Serialization) {
     TileMap map;
 
@@ -153,3 +193,323 @@ TEST(Grid, Serialization) {
     ASSERT_NE(t2, nullptr);
     EXPECT_EQ(t2->floor_id, 42);
 }
+
+TEST(Grid, BoundedChunkGrid) {
+    Tile floor;
+    floor.floor_id = 3;
+
+    // Chunks created before the bounds are set still become reachable
+    TileMap map;
+    map.set_tile({17, 2}, floor);
+    map.set_bounds(40, 24);
+
+    ASSERT_NE(map.get_tile({17, 2}), nullptr);
+    EXPECT_EQ(map.get_tile({17, 2})->floor_id, 3);
+    EXPECT_NE(map.get_tile({16, 15}), nullptr);     // Same chunk, default tile
+    EXPECT_EQ(map.get_tile({0, 0}), nullptr);       // No chunk yet
+
+    // Last partial chunk row/column
+    map.set_tile({39, 23}, floor);
+    ASSERT_NE(map.get_tile({39, 23}), nullptr);
+    EXPECT_EQ(map.get_tile({39, 23})->floor_id, 3);
+    EXPECT_EQ(map.get_chunk({32, 16}), map.get_chunk(Chunk::get_chunk_origin({39, 23})));
+
+    // Outside the bounds, including inside an allocated chunk's area
+    map.set_tile({40, 23}, floor);
+    EXPECT_EQ(map.get_tile({40, 23}), nullptr);
+    EXPECT_EQ(map.get_tile({-1, 0}), nullptr);
+    EXPECT_EQ(map.get_tile({0, -1}), nullptr);
+
+    // Round trip rebuilds the grid
+    Serializer s;
+    map.serialize(s);
+    TileMap copy;
+    Deserializer d(s.data());
+    copy.deserialize(d);
+    ASSERT_NE(copy.get_tile({39, 23}), nullptr);
+    EXPECT_EQ(copy.get_tile({17, 2})->floor_id, 3);
+
+    map.clear();
+    EXPECT_EQ(map.get_tile({17, 2}), nullptr);
+    EXPECT_EQ(map.chunk_count(), 0u);
+}
+
+TEST(Grid, TileBitplanes) {
+    Tile floor;
+    floor.floor_id = 1;
+    Tile wall = floor;
+    wall.flags = TileFlags::Solid | TileFlags::Opaque;
+    Tile water = floor;
+    water.flags = TileFlags::Liquid;
+
+    // Unbounded: a row crossing a chunk boundary at negative coordinates
+    TileMap map;
+    for (i32 x = -20; x < 20; ++x) {
+        map.set_tile({x, -3}, floor);
+    }
+    map.set_tile({-17, -3}, wall);
+    map.set_tile({-1, -3}, wall);
+    map.set_tile({0, -3}, water);
+
+    const Chunk* chunk = map.get_chunk({-16, -16});
+    ASSERT_NE(chunk, nullptr);
+    EXPECT_EQ(chunk->row_mask(TilePlane::Solid, 13), 1u << 15);
+    EXPECT_EQ(chunk->row_mask(TilePlane::Liquid, 13), 0u);
+
+    // Bit i = tile (-18 + i); -17 and -1 are walls, -20..-18 and beyond 19 are floor
+    EXPECT_EQ(map.row_mask(TilePlane::Solid, {-18, -3}, 20), (1ull << 1) | (1ull << 17));
+    EXPECT_EQ(map.row_mask(TilePlane::Opaque, {-18, -3}, 20), (1ull << 1) | (1ull << 17));
+    EXPECT_EQ(map.row_mask(TilePlane::Liquid, {-18, -3}, 20), 1ull << 18);
+
+    // No chunk at all: solid but not opaque
+    EXPECT_EQ(map.row_mask(TilePlane::Solid, {100, 100}, 64), ~0ull);
+    EXPECT_EQ(map.row_mask(TilePlane::Opaque, {100, 100}, 64), 0ull);
+
+    // Overwriting clears the old bits
+    map.set_tile({-1, -3}, floor);
+    EXPECT_EQ(map.row_mask(TilePlane::Solid, {-18, -3}, 20), 1ull << 1);
+
+    // Bounded: tiles past the edge of a partial chunk count as solid
+    TileMap bounded;
+    bounded.set_bounds(20, 20);
+    for (i32 y = 0; y < 20; ++y) {
+        for (i32 x = 0; x < 20; ++x) {
+            bounded.set_tile({x, y}, x == 5 && y == 5 ? wall : floor);
+        }
+    }
+    EXPECT_EQ(bounded.row_mask(TilePlane::Solid, {16, 0}, 8), 0xF0ull);
+    EXPECT_EQ(bounded.row_mask(TilePlane::Solid, {-2, 5}, 10), 0x3ull | (1ull << 7));
+    EXPECT_EQ(bounded.row_mask(TilePlane::Solid, {0, 20}, 4), 0xFull);
+    EXPECT_EQ(bounded.row_mask(TilePlane::Opaque, {-2, 5}, 10), 1ull << 7);
+
+    std::vector<u64> rows;
+    bounded.rect_mask(TilePlane::Solid, Recti{4, 4, 3, 3}, rows);
+    ASSERT_EQ(rows.size(), 3u);
+    EXPECT_EQ(rows[0], 0u);
+    EXPECT_EQ(rows[1], 0x2u);
+    EXPECT_EQ(rows[2], 0u);
+
+    EXPECT_TRUE(bounded.any_in_rect(TilePlane::Opaque, Recti{0, 0, 20, 20}));
+    EXPECT_FALSE(bounded.any_in_rect(TilePlane::Opaque, Recti{6, 0, 14, 20}));
+    EXPECT_FALSE(bounded.any_in_rect(TilePlane::Solid, Recti{6, 0, 14, 20}));
+    EXPECT_TRUE(bounded.any_in_rect(TilePlane::Solid, Recti{6, 0, 15, 20}));
+
+    // Chunk-wide writes keep the planes in sync
+    bounded.fill_chunk({0, 0}, water);
+    const Chunk& filled = *bounded.get_chunk({0, 0});
+    EXPECT_EQ(filled.row_mask(TilePlane::Liquid, 7), 0xFFFFu);
+    Serializer s;
+    filled.serialize(s);
+    Chunk copy;
+    Deserializer d(s.data());
+    copy.deserialize(d);
+    EXPECT_EQ(copy.plane(TilePlane::Liquid), filled.plane(TilePlane::Liquid));
+    EXPECT_EQ(copy.row_mask(TilePlane::Solid, 0), 0u);
+}
+
+TEST(Grid, ChunkVersionsAndDirtyTracking) {
+    Tile floor;
+    floor.floor_id = 1;
+    Tile door = floor;
+    door.wall_id = 9;
+    door.flags = TileFlags::Solid | TileFlags::Opaque;
+
+    TileMap map;
+    map.set_bounds(64, 64);
+    for (i32 y = 0; y < 64; ++y) {
+        for (i32 x = 0; x < 64; ++x) map.set_tile({x, y}, floor);
+    }
+    std::vector<TilePos> dirty;
+    map.drain_dirty_chunks(dirty);
+    EXPECT_EQ(dirty.size(), 16u);
+    map.drain_dirty_chunks(dirty);
+    EXPECT_TRUE(dirty.empty());
+
+    // Rewriting a tile as it is changes nothing
+    u32 version = map.get_chunk({16, 16})->version();
+    map.set_tile({20, 20}, floor);
+    EXPECT_EQ(map.get_chunk({16, 16})->version(), version);
+    EXPECT_EQ(map.dirty_chunk_count(), 0u);
+
+    // A door toggled back and forth dirties its chunk once
+    map.set_tile({20, 20}, door);
+    map.set_tile({20, 20}, floor);
+    map.set_tile({40, 3}, door);
+    u32 toggled = map.get_chunk({16, 16})->version();
+    EXPECT_GT(toggled, version);
+    EXPECT_LT(toggled, map.get_chunk({32, 0})->version());
+    map.drain_dirty_chunks(dirty);
+    ASSERT_EQ(dirty.size(), 2u);
+    EXPECT_EQ(dirty[0], TilePos(32, 0));
+    EXPECT_EQ(dirty[1], TilePos(16, 16));
+
+    map.fill_chunk({48, 48}, door);
+    map.fill_chunk({50, 48}, door);    // Not a chunk origin
+    map.drain_dirty_chunks(dirty);
+    ASSERT_EQ(dirty.size(), 1u);
+    EXPECT_TRUE(map.is_passable({47, 47}));
+    EXPECT_FALSE(map.is_passable({48, 48}));
+
+    // ChunkData payload: replaces the chunk on the other side, version included
+    TileMap replica;
+    replica.set_bounds(64, 64);
+    Serializer s;
+    ASSERT_TRUE(map.serialize_chunk(s, {16, 16}));
+    EXPECT_FALSE(map.serialize_chunk(s, {64, 64}));
+    Deserializer d(s.data());
+    u32 mask_version = replica.mask_version();
+    ASSERT_TRUE(replica.deserialize_chunk(d));
+    EXPECT_EQ(replica.get_chunk({16, 16})->version(), toggled);
+    EXPECT_GE(replica.content_version(), toggled);
+    EXPECT_EQ(replica.get_tile({20, 20})->floor_id, 1);
+    EXPECT_TRUE(replica.is_passable({20, 20}));
+    EXPECT_FALSE(replica.is_passable({0, 0}));
+    EXPECT_GT(replica.mask_version(), mask_version);
+
+    // Out of bounds chunks are rejected
+    TileMap small;
+    small.set_bounds(16, 16);
+    Deserializer again(s.data());
+    EXPECT_FALSE(small.deserialize_chunk(again));
+    EXPECT_EQ(small.chunk_count(), 0u);
+}
+
+TEST(Grid, ChunkVersionsSurviveRecreation) {
+    Tile floor;
+    floor.floor_id = 1;
+    Tile wall = floor;
+    wall.flags = TileFlags::Solid;
+
+    // What a client was last sent for the chunk, as ChunkSync remembers it
+    TileMap map;
+    map.set_tile({3, 3}, floor);
+    map.set_tile({4, 3}, wall);
+    u32 sent = map.get_chunk({0, 0})->version();
+
+    // Clearing and rebuilding the chunk with the same number of writes, or reloading the map,
+    // must not land on a version the client already has
+    map.clear();
+    map.set_tile({3, 3}, wall);
+    map.set_tile({4, 3}, floor);
+    u32 rebuilt = map.get_chunk({0, 0})->version();
+    EXPECT_GT(rebuilt, sent);
+
+    map.fill_chunk({0, 0}, floor);
+    EXPECT_GT(map.get_chunk({0, 0})->version(), rebuilt);
+
+    Serializer s;
+    map.serialize(s);
+    Deserializer d(s.data());
+    map.deserialize(d);
+    EXPECT_GT(map.get_chunk({0, 0})->version(), rebuilt);
+    EXPECT_EQ(map.get_chunk({0, 0})->version(), map.content_version());
+}
+
+TEST(Grid, ChunkEncoding) {
+    std::mt19937 rng(5);
+    auto round_trip = [](const Chunk& chunk) {
+        Serializer s;
+        chunk.serialize(s);
+        Chunk copy;
+        Deserializer d(s.data());
+        copy.deserialize(d);
+        EXPECT_TRUE(d.at_end());
+        EXPECT_EQ(copy.origin(), chunk.origin());
+        for (i32 y = 0; y < CHUNK_SIZE; ++y) {
+            for (i32 x = 0; x < CHUNK_SIZE; ++x) EXPECT_EQ(copy.at(x, y), chunk.at(x, y));
+        }
+        EXPECT_EQ(copy.plane(TilePlane::Solid), chunk.plane(TilePlane::Solid));
+        return s.size();
+    };
+
+    // Uniform, long runs, noise over small palettes, and every tile distinct
+    Tile grass;
+    grass.floor_id = 3;
+    TileMap map;
+    const TilePos origin{-16, 32};
+    map.fill_chunk(origin, grass);
+    const Chunk& chunk = *map.get_chunk(origin);
+    EXPECT_LE(round_trip(chunk), 16u);
+
+    Tile wall = grass;
+    wall.wall_id = 1;
+    wall.flags = TileFlags::Solid | TileFlags::Opaque;
+    for (i32 i = 0; i < CHUNK_SIZE; ++i) {
+        map.set_tile(origin + TilePos{i, 0}, wall);
+        map.set_tile(origin + TilePos{0, i}, wall);
+    }
+    EXPECT_LE(round_trip(chunk), 64u);
+
+    for (u32 palette : {2u, 3u, 5u, 17u, 200u}) {
+        for (i32 y = 0; y < CHUNK_SIZE; ++y) {
+            for (i32 x = 0; x < CHUNK_SIZE; ++x) {
+                Tile tile = grass;
+                tile.overlay_id = static_cast<u16>(rng() % palette);
+                tile.flags = tile.overlay_id % 2 ? TileFlags::Solid : TileFlags::None;
+                map.set_tile(origin + TilePos{x, y}, tile);
+            }
+        }
+        round_trip(chunk);
+    }
+    for (i32 i = 0; i < CHUNK_SIZE * CHUNK_SIZE; ++i) {
+        Tile tile = grass;
+        tile.overlay_id = static_cast<u16>(i);
+        map.set_tile(origin + TilePos{i % CHUNK_SIZE, i / CHUNK_SIZE}, tile);
+    }
+    round_trip(chunk);
+
+    // Malformed data throws rather than filling the chunk with garbage
+    Serializer s;
+    chunk.serialize(s);
+    std::vector<u8> truncated(s.data().begin(), s.data().end() - 1);
+    Chunk copy;
+    Deserializer d(truncated);
+    EXPECT_THROW(copy.deserialize(d), DeserializeError);
+    std::vector<u8> bad_encoding(s.data().begin(), s.data().end());
+    bad_encoding[8] = 7;
+    Deserializer bad(bad_encoding);
+    EXPECT_THROW(copy.deserialize(bad), DeserializeError);
+}
+
+TEST(Grid, CompactRegionSync) {
+    // A map like the server's: floor, border walls, a few rooms with doors and clutter
+    Tile floor;
+    floor.floor_id = 1;
+    Tile wall = floor;
+    wall.wall_id = 1;
+    wall.flags = TileFlags::Solid | TileFlags::Opaque;
+    Tile clutter = floor;
+    clutter.overlay_id = 4;
+
+    TileMap map;
+    map.set_bounds(128, 128);
+    std::mt19937 rng(8);
+    for (i32 y = 0; y < 128; ++y) {
+        for (i32 x = 0; x < 128; ++x) {
+            bool border = x == 0 || y == 0 || x == 127 || y == 127;
+            bool room = (x % 24 == 4 || y % 24 == 4) && x % 24 != 12 && y % 24 != 12;
+            Tile tile = border || room ? wall : floor;
+            if (!tile.has_wall() && rng() % 40 == 0) tile = clutter;
+            map.set_tile({x, y}, tile);
+        }
+    }
+
+    // The old encoding: origin and 7 bytes per tile
+    size_t uncompressed = 4 + map.chunk_count() * (8 + CHUNK_SIZE * CHUNK_SIZE * 7);
+    Serializer s;
+    map.serialize_region(s, Recti{0, 0, 128, 128});
+    EXPECT_LT(s.size() * 10, uncompressed);
+
+    Deserializer d(s.data());
+    u32 count = d.read_u32();
+    for (u32 i = 0; i < count; ++i) {
+        Chunk chunk;
+        chunk.deserialize(d);
+        for (i32 y = 0; y < CHUNK_SIZE; ++y) {
+            for (i32 x = 0; x < CHUNK_SIZE; ++x) {
+                TilePos pos = chunk.origin() + TilePos{x, y};
+                ASSERT_EQ(chunk.at(x, y), *map.get_tile(pos));
+            }
+        }
+    }
+}
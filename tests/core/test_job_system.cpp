@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include "core/util/job_system.hpp"
+#include "core/ecs/world.hpp"
+
+#include <atomic>
+#include <vector>
+
+using namespace city;
+
+TEST(JobSystem, ParallelForCoversRangeOnce) {
+    JobSystem jobs(3);
+
+    constexpr size_t COUNT = 10'000;
+    std::vector<std::atomic<int>> hits(COUNT);
+
+    jobs.parallel_for(COUNT, 16, [&hits](size_t begin, size_t end) {
+        EXPECT_LE(end - begin, 16u);
+        for (size_t i = begin; i < end; ++i) {
+            hits[i].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    for (size_t i = 0; i < COUNT; ++i) {
+        ASSERT_EQ(hits[i].load(), 1) << "index " << i;
+    }
+}
+
+TEST(JobSystem, InlineWithoutWorkers) {
+    JobSystem jobs(0);
+    EXPECT_EQ(jobs.thread_count(), 1u);
+
+    size_t total = 0;
+    jobs.parallel_for(100, 8, [&total](size_t begin, size_t end) { total += end - begin; });
+    EXPECT_EQ(total, 100u);
+}
+
+TEST(JobSystem, ThreadIndexIsPerPool) {
+    JobSystem outer(4);
+    JobSystem inner(1);
+    std::atomic<bool> in_range{true};
+
+    // Workers of one pool are index 0 to every other pool, even with a larger own index
+    outer.parallel_for(64, 1, [&](size_t, size_t) {
+        if (outer.thread_index() >= outer.thread_count()) in_range = false;
+        if (inner.thread_index() != 0) in_range = false;
+        inner.parallel_for(8, 1, [&](size_t, size_t) {
+            if (inner.thread_index() >= inner.thread_count()) in_range = false;
+        });
+    });
+    EXPECT_TRUE(in_range);
+    EXPECT_EQ(outer.thread_index(), 0u);
+}
+
+TEST(JobSystem, WorldParEachMatchesEach) {
+    struct Value { int v; };
+    struct Tag { int weight; };
+
+    JobSystem jobs(3);
+    World world;
+    for (int i = 0; i < 5000; ++i) {
+        Entity e = world.create();
+        world.add_component<Value>(e, {i});
+        if (i % 3 == 0) {
+            world.add_component<Tag>(e, {2});
+        }
+    }
+
+    world.par_each<Value, Tag>(jobs, [](Entity, Value& value, Tag& tag) {
+        value.v *= tag.weight;
+    }, 32);
+
+    long long sum = 0;
+    world.each<Value>([&sum](Entity, Value& value) { sum += value.v; });
+
+    long long expected = 0;
+    for (int i = 0; i < 5000; ++i) {
+        expected += (i % 3 == 0) ? i * 2 : i;
+    }
+    EXPECT_EQ(sum, expected);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "core/grid/tilemap.hpp"
+#include <random>
+#include <vector>
+
+// Tile maps shared by the grid tests (pathfinding, flow fields, field of view, visibility)
+namespace city::test {
+
+inline Tile floor_tile() {
+    Tile tile;
+    tile.floor_id = 1;
+    return tile;
+}
+
+// Blocks both movement and sight, so one map serves pathfinding and visibility tests
+inline Tile wall_tile() {
+    Tile tile;
+    tile.floor_id = 1;
+    tile.wall_id = 1;
+    tile.flags = TileFlags::Solid | TileFlags::Opaque;
+    return tile;
+}
+
+// Bounded width x height floor with walls at the given tiles
+inline TileMap make_map(i32 width, i32 height, const std::vector<TilePos>& walls = {}) {
+    TileMap map;
+    map.set_bounds(width, height);
+    for (i32 y = 0; y < height; ++y) {
+        for (i32 x = 0; x < width; ++x) map.set_tile({x, y}, floor_tile());
+    }
+    for (TilePos pos : walls) map.set_tile(pos, wall_tile());
+    return map;
+}
+
+// Bounded size x size map where each tile is a wall with probability wall_chance
+inline TileMap make_random_map(i32 size, u32 seed, f64 wall_chance) {
+    TileMap map;
+    map.set_bounds(size, size);
+    std::mt19937 rng(seed);
+    std::bernoulli_distribution blocked(wall_chance);
+    for (i32 y = 0; y < size; ++y) {
+        for (i32 x = 0; x < size; ++x) {
+            map.set_tile({x, y}, blocked(rng) ? wall_tile() : floor_tile());
+        }
+    }
+    return map;
+}
+
+} // namespace city::test
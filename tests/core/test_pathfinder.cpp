@@ -0,0 +1,309 @@
+#include <gtest/gtest.h>
+#include "core/grid/hierarchical_pathfinder.hpp"
+#include "core/grid/pathfinder.hpp"
+#include "test_maps.hpp"
+#include <atomic>
+#include <mutex>
+#include <random>
+
+using namespace city;
+using namespace city::test;
+
+namespace {
+
+// Path cost under the pathfinder's rules; fails the test on any illegal step
+u32 path_cost(const TileMap& map, const std::vector<TilePos>& path) {
+    u32 cost = 0;
+    for (size_t i = 1; i < path.size(); ++i) {
+        TilePos step = path[i] - path[i - 1];
+        EXPECT_LE(std::abs(step.x), 1);
+        EXPECT_LE(std::abs(step.y), 1);
+        EXPECT_TRUE(map.is_passable(path[i]));
+        if (step.x != 0 && step.y != 0) {
+            EXPECT_TRUE(map.is_passable(path[i - 1] + TilePos{step.x, 0}));
+            EXPECT_TRUE(map.is_passable(path[i - 1] + TilePos{0, step.y}));
+            cost += 14;
+        } else {
+            cost += 10;
+        }
+    }
+    return cost;
+}
+
+} // namespace
+
+TEST(Pathfinder, StraightAndDiagonal) {
+    TileMap map = make_map(16, 16);
+    Pathfinder pathfinder(map);
+    std::vector<TilePos> path;
+
+    for (PathAlgorithm algorithm : {PathAlgorithm::AStar, PathAlgorithm::JumpPoint}) {
+        PathOptions options;
+        options.algorithm = algorithm;
+
+        ASSERT_TRUE(pathfinder.find_path({1, 1}, {6, 4}, path, options));
+        EXPECT_EQ(path.front(), TilePos(1, 1));
+        EXPECT_EQ(path.back(), TilePos(6, 4));
+        EXPECT_EQ(path.size(), 6u);
+        EXPECT_EQ(path_cost(map, path), 3 * 14 + 2 * 10u);
+
+        ASSERT_TRUE(pathfinder.find_path({3, 3}, {3, 3}, path, options));
+        EXPECT_EQ(path.size(), 1u);
+    }
+
+    PathOptions cardinal;
+    cardinal.allow_diagonal = false;
+    ASSERT_TRUE(pathfinder.find_path({1, 1}, {6, 4}, path, cardinal));
+    EXPECT_EQ(path.size(), 9u);
+}
+
+TEST(Pathfinder, NoCornerCutting) {
+    // . # .
+    // . . .      Going (0,0) -> (2,0) must not slip diagonally past the wall at (1,0)
+    TileMap map = make_map(3, 2, {{1, 0}});
+    Pathfinder pathfinder(map);
+    std::vector<TilePos> path;
+
+    for (PathAlgorithm algorithm : {PathAlgorithm::AStar, PathAlgorithm::JumpPoint}) {
+        PathOptions options;
+        options.algorithm = algorithm;
+        ASSERT_TRUE(pathfinder.find_path({0, 0}, {2, 0}, path, options));
+        EXPECT_EQ(path_cost(map, path), 40u);
+    }
+}
+
+TEST(Pathfinder, Unreachable) {
+    std::vector<TilePos> walls;
+    for (i32 y = 0; y < 10; ++y) walls.push_back({5, y});
+    TileMap map = make_map(10, 10, walls);
+    Pathfinder pathfinder(map);
+    std::vector<TilePos> path{{0, 0}};
+
+    EXPECT_FALSE(pathfinder.find_path({1, 1}, {8, 8}, path));
+    EXPECT_TRUE(path.empty());
+    EXPECT_FALSE(pathfinder.find_path({1, 1}, {5, 5}, path));      // Goal is a wall
+    EXPECT_FALSE(pathfinder.find_path({1, 1}, {20, 1}, path));     // Outside the map
+
+    PathOptions limited;
+    limited.algorithm = PathAlgorithm::AStar;
+    limited.max_expanded = 3;
+    EXPECT_FALSE(pathfinder.find_path({0, 0}, {4, 9}, path, limited));
+}
+
+TEST(Pathfinder, JumpPointMatchesAStar) {
+    // Wider than one 64-bit word so JPS scans cross word boundaries both ways
+    constexpr i32 SIZE = 100;
+    std::mt19937 rng(99);
+    std::uniform_int_distribution<i32> coord(0, SIZE - 1);
+    std::bernoulli_distribution blocked(0.3);
+
+    std::vector<TilePos> walls;
+    for (i32 y = 0; y < SIZE; ++y) {
+        for (i32 x = 0; x < SIZE; ++x) {
+            if (blocked(rng)) walls.push_back({x, y});
+        }
+    }
+    TileMap map = make_map(SIZE, SIZE, walls);
+    Pathfinder pathfinder(map);
+
+    PathOptions astar;
+    astar.algorithm = PathAlgorithm::AStar;
+    std::vector<TilePos> astar_path;
+    std::vector<TilePos> jps_path;
+    u32 found = 0;
+    for (int i = 0; i < 300; ++i) {
+        TilePos start{coord(rng), coord(rng)};
+        TilePos goal{coord(rng), coord(rng)};
+        bool astar_found = pathfinder.find_path(start, goal, astar_path, astar);
+        bool jps_found = pathfinder.find_path(start, goal, jps_path);
+        ASSERT_EQ(astar_found, jps_found);
+        if (!astar_found) continue;
+
+        ++found;
+        EXPECT_EQ(jps_path.front(), start);
+        EXPECT_EQ(jps_path.back(), goal);
+        EXPECT_EQ(path_cost(map, jps_path), path_cost(map, astar_path));
+    }
+    EXPECT_GT(found, 50u);
+}
+
+TEST(Pathfinder, SeesMapEdits) {
+    TileMap map = make_map(8, 3);
+    Pathfinder pathfinder(map);
+    std::vector<TilePos> path;
+    ASSERT_TRUE(pathfinder.find_path({0, 1}, {7, 1}, path));
+    EXPECT_EQ(path.size(), 8u);
+
+    // Close the corridor, then open a door in it
+    Tile wall;
+    wall.flags = TileFlags::Solid;
+    for (i32 y = 0; y < 3; ++y) map.set_tile({4, y}, wall);
+    EXPECT_FALSE(pathfinder.find_path({0, 1}, {7, 1}, path));
+
+    Tile floor;
+    floor.floor_id = 1;
+    map.set_tile({4, 2}, floor);
+    ASSERT_TRUE(pathfinder.find_path({0, 1}, {7, 1}, path));
+    EXPECT_EQ(path_cost(map, path), 5 * 10 + 2 * 14u);
+}
+
+TEST(Pathfinder, UnboundedMap) {
+    TileMap map;
+    Tile floor;
+    floor.floor_id = 1;
+    for (i32 y = -20; y < -4; ++y) {
+        for (i32 x = -20; x < 4; ++x) {
+            map.set_tile({x, y}, floor);
+        }
+    }
+
+    Pathfinder pathfinder(map);
+    std::vector<TilePos> path;
+    ASSERT_TRUE(pathfinder.find_path({-18, -18}, {2, -6}, path));
+    EXPECT_EQ(path_cost(map, path), 12 * 14 + 8 * 10u);
+
+    // Loading a chunk past the old edge grows the search area of a warm pathfinder
+    EXPECT_FALSE(pathfinder.find_path({2, -6}, {18, -6}, path));
+    map.set_tile({18, -6}, floor);
+    ASSERT_TRUE(pathfinder.find_path({2, -6}, {18, -6}, path));
+    EXPECT_EQ(path_cost(map, path), 16 * 10u);
+}
+
+TEST(Pathfinder, Batched) {
+    TileMap map = make_map(32, 32, {{10, 10}, {10, 11}, {10, 12}, {11, 10}});
+    Pathfinder pathfinder(map);
+
+    std::vector<PathRequest> requests;
+    for (i32 i = 0; i < 64; ++i) {
+        requests.push_back({{i % 32, 0}, {31 - i % 32, 31}});
+    }
+    requests.push_back({{0, 0}, {10, 10}});     // Unreachable goal
+
+    std::vector<std::vector<TilePos>> sequential(requests.size());
+    pathfinder.find_paths(requests, sequential);
+
+    JobSystem jobs(3);
+    std::vector<std::vector<TilePos>> parallel(requests.size());
+    pathfinder.find_paths(requests, parallel, jobs);
+
+    for (size_t i = 0; i + 1 < requests.size(); ++i) {
+        ASSERT_FALSE(sequential[i].empty());
+        EXPECT_EQ(sequential[i].front(), requests[i].start);
+        EXPECT_EQ(sequential[i].back(), requests[i].goal);
+        EXPECT_EQ(path_cost(map, parallel[i]), path_cost(map, sequential[i]));
+    }
+    EXPECT_TRUE(sequential.back().empty());
+    EXPECT_TRUE(parallel.back().empty());
+
+    // Batches started from workers of a larger pool index scratch by their place in `jobs`
+    JobSystem outer(4);
+    std::mutex one_batch_at_a_time;
+    std::atomic<bool> matches{true};
+    outer.parallel_for(8, 1, [&](size_t, size_t) {
+        std::vector<std::vector<TilePos>> nested(requests.size());
+        std::lock_guard lock(one_batch_at_a_time);
+        pathfinder.find_paths(requests, nested, jobs);
+        for (size_t i = 0; i < requests.size(); ++i) {
+            if (path_cost(map, nested[i]) != path_cost(map, sequential[i])) matches = false;
+        }
+    });
+    EXPECT_TRUE(matches);
+}
+
+TEST(HierarchicalPathfinder, NearOptimalPaths) {
+    constexpr i32 SIZE = 96;
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<i32> coord(0, SIZE - 1);
+    std::bernoulli_distribution blocked(0.25);
+
+    std::vector<TilePos> walls;
+    for (i32 y = 0; y < SIZE; ++y) {
+        for (i32 x = 0; x < SIZE; ++x) {
+            if (blocked(rng)) walls.push_back({x, y});
+        }
+    }
+    TileMap map = make_map(SIZE, SIZE, walls);
+    Pathfinder exact(map);
+    HierarchicalPathfinder hierarchical(map);
+
+    std::vector<TilePos> exact_path;
+    std::vector<TilePos> path;
+    u32 found = 0;
+    for (int i = 0; i < 300; ++i) {
+        TilePos start{coord(rng), coord(rng)};
+        TilePos goal{coord(rng), coord(rng)};
+        bool exact_found = exact.find_path(start, goal, exact_path);
+        ASSERT_EQ(hierarchical.find_path(start, goal, path), exact_found);
+        if (!exact_found) continue;
+
+        ++found;
+        EXPECT_EQ(path.front(), start);
+        EXPECT_EQ(path.back(), goal);
+        u32 optimal = path_cost(map, exact_path);
+        u32 cost = path_cost(map, path);
+        EXPECT_GE(cost, optimal);
+        EXPECT_LE(cost, optimal + optimal / 4 + 20);
+    }
+    EXPECT_GT(found, 100u);
+}
+
+TEST(HierarchicalPathfinder, IncrementalRebuild) {
+    TileMap map = make_map(64, 64);
+    HierarchicalPathfinder pathfinder(map);
+    pathfinder.update();
+    EXPECT_EQ(pathfinder.last_rebuilt_clusters(), 16u);
+    size_t nodes = pathfinder.node_count();
+
+    std::vector<TilePos> path;
+    ASSERT_TRUE(pathfinder.find_path({1, 1}, {62, 62}, path));
+    EXPECT_EQ(pathfinder.last_rebuilt_clusters(), 0u);
+    EXPECT_LE(path_cost(map, path), 61 * 14u * 11 / 10);
+
+    // A wall inside one chunk leaves every entrance where it was
+    Tile wall;
+    wall.flags = TileFlags::Solid;
+    map.set_tile({40, 40}, wall);
+    pathfinder.update();
+    EXPECT_EQ(pathfinder.last_rebuilt_clusters(), 1u);
+    EXPECT_EQ(pathfinder.node_count(), nodes);
+
+    // Narrowing the border between chunks (0,0) and (1,0) also rebuilds the chunk across it
+    for (i32 y = 0; y < 12; ++y) map.set_tile({15, y}, wall);
+    pathfinder.update();
+    EXPECT_EQ(pathfinder.last_rebuilt_clusters(), 2u);
+
+    // Wall off chunk (0,0) entirely; the old border entrances must be gone
+    for (i32 i = 0; i < 16; ++i) {
+        map.set_tile({i, 15}, wall);
+        map.set_tile({15, i}, wall);
+    }
+    EXPECT_FALSE(pathfinder.find_path({1, 1}, {62, 62}, path));
+    EXPECT_TRUE(path.empty());
+    ASSERT_TRUE(pathfinder.find_path({1, 1}, {13, 1}, path));
+    EXPECT_EQ(path_cost(map, path), 12 * 10u);
+
+    Tile floor;
+    floor.floor_id = 1;
+    map.set_tile({15, 8}, floor);
+    ASSERT_TRUE(pathfinder.find_path({1, 1}, {62, 62}, path));
+    EXPECT_EQ(path.back(), TilePos(62, 62));
+    path_cost(map, path);
+}
+
+TEST(HierarchicalPathfinder, UnboundedMap) {
+    TileMap map;
+    Tile floor;
+    floor.floor_id = 1;
+    for (i32 y = -20; y < 12; ++y) {
+        for (i32 x = -40; x < 4; ++x) {
+            map.set_tile({x, y}, floor);
+        }
+    }
+
+    HierarchicalPathfinder pathfinder(map);
+    std::vector<TilePos> path;
+    ASSERT_TRUE(pathfinder.find_path({-38, -18}, {2, 10}, path));
+    EXPECT_EQ(path.back(), TilePos(2, 10));
+    EXPECT_LE(path_cost(map, path), (28 * 14 + 12 * 10u) * 12 / 10);
+    EXPECT_FALSE(pathfinder.find_path({-38, -18}, {20, 10}, path));
+}
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "core/net/serialization.hpp"
+#include "core/net/compression.hpp"
 
 using namespace city;
 
@@ -80,3 +81,25 @@ TEST(Serialization, UnexpectedEnd) {
     d.read_u8();
     EXPECT_THROW(d.read_u8(), DeserializeError);
 }
+
+TEST(Serialization, PackedPayload) {
+    // Small bodies stay raw
+    std::vector<u8> small{1, 2, 3};
+    std::vector<u8> packed = net::pack_payload(small);
+    EXPECT_EQ(packed[0], static_cast<u8>(net::PayloadCodec::Raw));
+    EXPECT_EQ(net::unpack_payload(packed), small);
+
+    // Repetitive bodies compress
+    std::vector<u8> body(4096);
+    for (size_t i = 0; i < body.size(); ++i) body[i] = static_cast<u8>(i % 7);
+    packed = net::pack_payload(body);
+    EXPECT_EQ(packed[0], static_cast<u8>(net::PayloadCodec::Zstd));
+    EXPECT_LT(packed.size(), body.size() / 10);
+    EXPECT_EQ(net::unpack_payload(packed), body);
+
+    // Corrupt or unknown framing is rejected
+    packed.resize(packed.size() / 2);
+    EXPECT_THROW(net::unpack_payload(packed), DeserializeError);
+    EXPECT_THROW(net::unpack_payload(std::vector<u8>{9, 1, 2}), DeserializeError);
+    EXPECT_THROW(net::unpack_payload(std::vector<u8>{}), DeserializeError);
+}
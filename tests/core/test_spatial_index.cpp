@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+#include "core/game/components/transform.hpp"
+#include "core/game/systems/spatial_index.hpp"
+#include <algorithm>
+#include <random>
+
+using namespace city;
+
+namespace {
+
+bool entity_less(Entity a, Entity b) {
+    return a.index != b.index ? a.index < b.index : a.generation < b.generation;
+}
+
+std::vector<Entity> sorted(std::vector<Entity> entities) {
+    std::sort(entities.begin(), entities.end(), entity_less);
+    return entities;
+}
+
+f32 distance_sq(Vec2f a, Vec2f b) {
+    Vec2f d = a - b;
+    return d.x * d.x + d.y * d.y;
+}
+
+} // namespace
+
+TEST(SpatialIndex, QueriesMatchBruteForce) {
+    std::mt19937 rng(12);
+    std::uniform_real_distribution<f32> coord(-150.0f, 150.0f);
+    SpatialIndex index;
+
+    // Positions by entity index; NaN x = not indexed
+    std::vector<Vec2f> positions(400);
+    for (u32 i = 0; i < positions.size(); ++i) {
+        positions[i] = {coord(rng), coord(rng)};
+        index.insert({i, 0}, positions[i]);
+    }
+
+    std::vector<Entity> found;
+    std::vector<Entity> expected;
+    std::vector<SpatialIndex::Neighbor> nearest;
+    for (int round = 0; round < 50; ++round) {
+        // Small steps (mostly within a cell), teleports and removals
+        for (u32 i = 0; i < positions.size(); ++i) {
+            if (std::isnan(positions[i].x)) {
+                if (rng() % 10 == 0) {
+                    positions[i] = {coord(rng), coord(rng)};
+                    index.move({i, 0}, positions[i]);
+                }
+                continue;
+            }
+            switch (rng() % 20) {
+                case 0:
+                    positions[i] = {coord(rng), coord(rng)};
+                    index.move({i, 0}, positions[i]);
+                    break;
+                case 1:
+                    positions[i].x = std::nanf("");
+                    index.remove({i, 0});
+                    break;
+                default:
+                    positions[i].x += 1.5f;
+                    positions[i].y -= 0.75f;
+                    index.move({i, 0}, positions[i]);
+                    break;
+            }
+        }
+
+        Vec2f center{coord(rng), coord(rng)};
+        f32 radius = static_cast<f32>(rng() % 40);
+        expected.clear();
+        for (u32 i = 0; i < positions.size(); ++i) {
+            if (std::isnan(positions[i].x)) continue;
+            if (distance_sq(positions[i], center) <= radius * radius) expected.push_back({i, 0});
+        }
+        index.query_radius(center, radius, found);
+        ASSERT_EQ(sorted(found), sorted(expected)) << round;
+
+        Rectf rect{center.x, center.y, radius * 2.0f, radius};
+        expected.clear();
+        for (u32 i = 0; i < positions.size(); ++i) {
+            if (!std::isnan(positions[i].x) && rect.contains(positions[i])) {
+                expected.push_back({i, 0});
+            }
+        }
+        index.query_rect(rect, found);
+        ASSERT_EQ(sorted(found), sorted(expected)) << round;
+
+        // k nearest: same distances as the k smallest of a full sort
+        std::vector<f32> distances;
+        for (const Vec2f& position : positions) {
+            if (!std::isnan(position.x)) distances.push_back(distance_sq(position, center));
+        }
+        std::sort(distances.begin(), distances.end());
+        size_t k = 1 + rng() % 12;
+        ASSERT_EQ(index.query_nearest(center, k, nearest), std::min(k, distances.size()));
+        for (size_t i = 0; i < nearest.size(); ++i) {
+            ASSERT_EQ(nearest[i].distance_sq, distances[i]) << round << " " << i;
+            ASSERT_EQ(distance_sq(positions[nearest[i].entity.index], center),
+                      nearest[i].distance_sq);
+        }
+
+        // Limited by max_radius
+        index.query_nearest(center, 1000, nearest, radius);
+        ASSERT_EQ(nearest.size(), static_cast<size_t>(std::count_if(
+            distances.begin(), distances.end(), [&](f32 d) { return d <= radius * radius; })));
+    }
+    EXPECT_EQ(index.size(), static_cast<size_t>(std::count_if(
+        positions.begin(), positions.end(), [](Vec2f p) { return !std::isnan(p.x); })));
+
+    // Far outliers don't stop nearest queries from finishing
+    index.insert({1000, 0}, {1.0e6f, -1.0e6f});
+    index.query_nearest({1.0e6f, -1.0e6f + 3.0f}, 1, nearest);
+    ASSERT_EQ(nearest.size(), 1u);
+    EXPECT_EQ(nearest[0].entity, (Entity{1000, 0}));
+}
+
+TEST(SpatialIndex, FollowsWorld) {
+    World world;
+    SpatialIndex index;
+
+    Entity a = world.create();
+    world.add_component<Transform>(a, Transform{.position = {2.0f, 2.0f}});
+    index.attach(world);
+    EXPECT_TRUE(index.contains(a));
+
+    Entity b = world.create();
+    world.add_component<Transform>(b, Transform{.position = {40.0f, 2.0f}});
+    Entity c = world.create();
+    world.add_component<Transform>(c, Transform{.position = {3.0f, 3.0f}});
+    EXPECT_FALSE(index.contains(b));     // Until the signals are dispatched
+    world.dispatch_signals();
+    EXPECT_EQ(index.size(), 3u);
+
+    std::vector<Entity> found;
+    EXPECT_EQ(index.query_radius({2.0f, 2.0f}, 5.0f, found), 2u);
+
+    // Across a cell boundary, and within one
+    world.get_mut<Transform>(b)->position = {4.0f, 2.0f};
+    world.get_mut<Transform>(c)->position = {3.5f, 3.0f};
+    world.dispatch_signals();
+    EXPECT_EQ(index.query_radius({2.0f, 2.0f}, 5.0f, found), 3u);
+    EXPECT_EQ(index.query_rect({3.25f, 2.5f, 0.5f, 1.0f}, found), 1u);
+    EXPECT_EQ(found[0], c);
+
+    // Removal, destruction and a recycled entity slot
+    world.remove_component<Transform>(a);
+    world.destroy(b);
+    Entity d = world.create();
+    world.add_component<Transform>(d, Transform{.position = {60.0f, 60.0f}});
+    world.dispatch_signals();
+    EXPECT_EQ(index.size(), 2u);
+    EXPECT_FALSE(index.contains(a));
+    EXPECT_FALSE(index.contains(b));
+    EXPECT_TRUE(index.contains(d));
+    EXPECT_EQ(index.query_radius({2.0f, 2.0f}, 5.0f, found), 1u);
+
+    std::vector<SpatialIndex::Neighbor> nearest;
+    EXPECT_EQ(index.query_nearest({50.0f, 50.0f}, 1, nearest), 1u);
+    EXPECT_EQ(nearest[0].entity, d);
+
+    // Detached: no more updates
+    index.detach();
+    world.get_mut<Transform>(d)->position = {0.0f, 0.0f};
+    world.dispatch_signals();
+    EXPECT_EQ(index.query_radius({60.0f, 60.0f}, 1.0f, found), 1u);
+}
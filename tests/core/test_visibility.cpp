@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include "core/game/systems/visibility.hpp"
+#include "test_maps.hpp"
+#include <random>
+
+using namespace city;
+using namespace city::test;
+
+namespace {
+
+std::vector<TilePos> random_tiles(size_t count, i32 size, std::mt19937& rng) {
+    std::uniform_int_distribution<i32> coord(0, size - 1);
+    std::vector<TilePos> tiles(count);
+    for (TilePos& tile : tiles) tile = {coord(rng), coord(rng)};
+    return tiles;
+}
+
+} // namespace
+
+TEST(Visibility, MatchesFieldOfView) {
+    TileMap map = make_random_map(96, 2, 0.15);
+    std::mt19937 rng(7);
+    std::vector<TilePos> viewers = random_tiles(40, 96, rng);
+    std::vector<TilePos> targets = viewers;
+    std::vector<TilePos> others = random_tiles(500, 96, rng);
+    targets.insert(targets.end(), others.begin(), others.end());
+
+    JobSystem jobs(3);
+    VisibilitySystem visibility(map, SHOUT_RANGE);
+    visibility.update(viewers, targets, jobs);
+    EXPECT_EQ(visibility.last_recomputed(), 40u);
+    ASSERT_EQ(visibility.visible_targets(0).size(), (targets.size() + 63) / 64);
+
+    u32 seen = 0;
+    FieldOfView fov;
+    for (size_t v = 0; v < viewers.size(); ++v) {
+        fov.compute(map, viewers[v], SHOUT_RANGE);
+        EXPECT_TRUE(visibility.sees(v, v));
+        for (size_t t = 0; t < targets.size(); ++t) {
+            ASSERT_EQ(visibility.sees(v, t), fov.is_visible(targets[t])) << v << " " << t;
+            seen += visibility.sees(v, t);
+        }
+    }
+    EXPECT_GT(seen, 100u);
+
+    // A target far off makes the targets too sparse to bin; results are the same
+    targets.push_back({100000, -100000});
+    visibility.update(viewers, targets, jobs);
+    EXPECT_EQ(visibility.last_recomputed(), 0u);
+    for (size_t v = 0; v < viewers.size(); ++v) {
+        fov.compute(map, viewers[v], SHOUT_RANGE);
+        for (size_t t = 0; t < targets.size(); ++t) {
+            ASSERT_EQ(visibility.sees(v, t), fov.is_visible(targets[t])) << v << " " << t;
+        }
+    }
+}
+
+TEST(Visibility, RecomputesMovedViewersOnly) {
+    TileMap map = make_random_map(128, 3, 0.15);
+    std::vector<TilePos> viewers{{10, 10}, {60, 60}, {100, 20}};
+    JobSystem jobs(0);
+    VisibilitySystem visibility(map, 8);
+
+    visibility.update(viewers, viewers, jobs);
+    EXPECT_EQ(visibility.last_recomputed(), 3u);
+    visibility.update(viewers, viewers, jobs);
+    EXPECT_EQ(visibility.last_recomputed(), 0u);
+
+    viewers[1] = {61, 60};
+    visibility.update(viewers, viewers, jobs);
+    EXPECT_EQ(visibility.last_recomputed(), 1u);
+
+    // An opaque edit only invalidates the viewers over that chunk
+    Tile wall;
+    wall.flags = TileFlags::Solid | TileFlags::Opaque;
+    map.set_tile({12, 12}, wall);
+    visibility.update(viewers, viewers, jobs);
+    EXPECT_EQ(visibility.last_recomputed(), 1u);
+    EXPECT_EQ(visibility.field_of_view(0).origin(), TilePos(10, 10));
+    EXPECT_TRUE(visibility.field_of_view(0).is_current(map));
+
+    // Viewers far apart don't see each other
+    EXPECT_FALSE(visibility.sees(0, 2));
+    EXPECT_EQ(visibility.viewer_count(), 3u);
+    EXPECT_EQ(visibility.target_count(), 3u);
+}